@@ -5,10 +5,12 @@
  * @brief Python interface for svZeroDSolver
  */
 #include <pybind11/eigen.h>
+#include <pybind11/numpy.h>
 #include <pybind11/operators.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include "ResultReader.h"
 #include "Solver.h"
 #include "calibrate.h"
 #include "pybind11_json/pybind11_json.hpp"
@@ -33,6 +35,56 @@ PYBIND11_MODULE(pysvzerod, m) {
       .def("get_single_result_avg", &Solver::get_single_result_avg)
       .def("update_block_params", &Solver::update_block_params)
       .def("read_block_params", &Solver::read_block_params)
+      .def(
+          "run_ensemble",
+          [](Solver& solver, const std::vector<std::string>& block_names,
+             const Eigen::MatrixXd& block_params,
+             const std::vector<std::string>& outputs, int num_threads) {
+            EnsembleResult result;
+            {
+              py::gil_scoped_release release;
+              result = solver.run_ensemble(block_names, block_params, outputs,
+                                           num_threads);
+            }
+            py::dict values;
+            values["time"] = result.times;
+            for (size_t i = 0; i < outputs.size(); i++) {
+              values[py::str(outputs[i])] = result.values[i];
+            }
+            return values;
+          },
+          py::arg("block_names"), py::arg("block_params"), py::arg("outputs"),
+          py::arg("num_threads") = 0)
+      .def("get_statistics",
+           [](Solver& solver) {
+             SolverStatistics statistics = solver.get_statistics();
+             const auto& linear = statistics.linear_solver_statistics;
+             py::dict values;
+             values["linear_solver"] = statistics.linear_solver;
+             values["num_factorizations"] = linear.num_factorizations;
+             values["num_full_factorizations"] =
+                 linear.num_full_factorizations;
+             values["num_solves"] = linear.num_solves;
+             values["factorization_time"] = linear.factorization_time;
+             values["solve_time"] = linear.solve_time;
+             values["num_saved_factorizations"] =
+                 statistics.num_saved_factorizations;
+             values["num_nonlinear_iterations"] =
+                 statistics.num_nonlinear_iterations;
+             values["num_line_search_backtracks"] =
+                 statistics.num_line_search_backtracks;
+             values["num_rejected_steps"] = statistics.num_rejected_steps;
+             values["num_adaptive_steps"] = statistics.num_adaptive_steps;
+             values["num_rejected_adaptive_steps"] =
+                 statistics.num_rejected_adaptive_steps;
+             values["num_periodic_steady_state_iterations"] =
+                 statistics.num_periodic_steady_state_iterations;
+             values["num_periodic_steady_state_cycles"] =
+                 statistics.num_periodic_steady_state_cycles;
+             values["periodic_steady_state_error"] =
+                 statistics.periodic_steady_state_error;
+             return values;
+           })
       .def("get_full_result", [](Solver& solver) {
         py::module_ pd = py::module_::import("pandas");
         py::module_ io = py::module_::import("io");
@@ -57,6 +109,43 @@ PYBIND11_MODULE(pysvzerod, m) {
     solver.run();
     return pd.attr("read_csv")(io.attr("StringIO")(solver.get_full_result()));
   });
+  m.def("read_result", [](std::string filename) {
+    // The arrays are read-only views into the mapped file, which is unmapped
+    // when the last of them is deleted
+    auto reader = new ResultReader(filename);
+    py::capsule base(reader, [](void* pointer) {
+      delete static_cast<ResultReader*>(pointer);
+    });
+    size_t num_times = reader->get_num_times();
+    size_t num_variables = reader->get_variables().size();
+    auto view = [&](const void* data, std::vector<size_t> shape,
+                    size_t value_size) {
+      py::dtype dtype = (value_size == sizeof(float)) ? py::dtype::of<float>()
+                                                      : py::dtype::of<double>();
+      std::vector<size_t> strides(shape.size(), value_size);
+      if (shape.size() == 2) {
+        strides[0] = shape[1] * value_size;
+      }
+      py::array array(dtype, shape, strides, data, base);
+      array.attr("flags").attr("writeable") = false;
+      return array;
+    };
+    py::dict result;
+    result["time"] = view(reader->get_times(), {num_times}, sizeof(double));
+    result["variables"] = reader->get_variables();
+    result["y"] = view(reader->get_data(), {num_variables, num_times},
+                       reader->get_value_size());
+    if (reader->has_derivative()) {
+      result["ydot"] = view(reader->get_data(true), {num_variables, num_times},
+                            reader->get_value_size());
+    }
+    py::dict vessels;
+    for (auto& vessel : reader->get_vessels()) {
+      vessels[py::str(vessel.name)] = vessel.dofs;
+    }
+    result["vessels"] = vessels;
+    return result;
+  });
   m.def("calibrate", [](py::dict& config) {
     const nlohmann::json& config_json = config;
     return calibrate(config);
@@ -72,8 +161,8 @@ PYBIND11_MODULE(pysvzerod, m) {
     std::ifstream ifs(argv[1]);
     const auto& config = nlohmann::json::parse(ifs);
     auto solver = Solver(config);
-    solver.run();
-    solver.write_result_to_csv(argv[2]);
+    auto sink = solver.create_output_sink(argv[2]);
+    solver.run(*sink);
   });
   m.def("run_calibration_cli", []() {
     py::module_ sys = py::module_::import("sys");
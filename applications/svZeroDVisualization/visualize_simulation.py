@@ -4,6 +4,7 @@
 import sys
 import argparse
 import pysvzerod
+import numpy as np
 import pandas as pd
 import matplotlib.pyplot as plt
 import networkx as nx
@@ -23,13 +24,36 @@ as a directed graph. Users can interactively select nodes to view their paramete
 Enter the filepath for your simulation input JSON file and the directory where 
 you want to save the output directed graph as command line arguments to run the script. 
 If you want to save the raw svZeroDSolver simulation results, add "export-csv" as the third command line argument.
+If you already have the results in a binary result file (written with "output_format": "binary"), pass it with
+"--results" to open it instead of running the simulation.
 
 '''
 
-def dirgraph(filepath, output_dir, export_csv):
-    solver = pysvzerod.Solver(filepath)
-    solver.run()
-    results = pd.DataFrame(solver.get_full_result())
+def read_binary_results(results_file):
+    '''
+    Read a binary result file into a vessel based dataframe (as returned by get_full_result)
+    '''
+    result = pysvzerod.read_result(results_file)
+    time = result['time']
+    y = result['y']
+    columns = {'name': [], 'time': [], 'flow_in': [], 'flow_out': [], 'pressure_in': [], 'pressure_out': []}
+    for name, dofs in result['vessels'].items():
+        columns['name'].extend([name] * len(time))
+        columns['time'].append(time)
+        for column, dof in zip(['flow_in', 'flow_out', 'pressure_in', 'pressure_out'], dofs):
+            columns[column].append(y[dof])
+    for column in ['time', 'flow_in', 'flow_out', 'pressure_in', 'pressure_out']:
+        columns[column] = np.concatenate(columns[column]) if columns[column] else []
+    return pd.DataFrame(columns)
+
+
+def dirgraph(filepath, output_dir, export_csv, results_file=None):
+    if results_file:
+        results = read_binary_results(results_file)
+    else:
+        solver = pysvzerod.Solver(filepath)
+        solver.run()
+        results = pd.DataFrame(solver.get_full_result())
 
     if export_csv:
         results.to_csv('results.csv', sep=',', index=False, encoding='utf-8')
@@ -75,11 +99,17 @@ def main():
         help="If specified, export the results as CSV files."
     )
 
+    parser.add_argument(
+        '--results',
+        type=str,
+        help="Binary svZeroDSolver result file to open instead of running the simulation."
+    )
+
     # Parse the arguments
     args = parser.parse_args()
 
     # Call the dirgraph function with the provided arguments
-    return dirgraph(args.filepath, args.output_dir, args.export_csv)
+    return dirgraph(args.filepath, args.output_dir, args.export_csv, args.results)
 
 if __name__ == '__main__':
     results, parameters, G = main()
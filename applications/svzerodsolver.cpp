@@ -18,8 +18,7 @@
  * 1. Read the input file
  * 2. Create the 0D model
  * 3. (Optional) Solve for steady initial condition
- * 4. Run simulation
- * 5. Write output to file
+ * 4. Run simulation and write output to file
  *
  * @param argc Number of command line arguments
  * @param argv Command line arguments
@@ -84,9 +83,23 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
+  // Write the output while integrating (see Solver::create_output_sink), the
+  // sink deletes its incomplete output if the simulation fails
   auto solver = Solver(config);
-  solver.run();
-  solver.write_result_to_csv(output_file_name);
+  auto sink = solver.create_output_sink(output_file_name);
+  try {
+    solver.run(*sink);
+  } catch (const std::runtime_error& e) {
+    sink.reset();
+    std::cerr << "[svzerodsolver] Error: " << e.what() << std::endl;
+    return 1;
+  }
+
+  // Only with the allocation counter (test hook, see get_num_allocations)
+  if (solver.get_num_time_loop_allocations() >= 0) {
+    std::cout << "[svzerodsolver] Heap allocations in time loop: "
+              << solver.get_num_time_loop_allocations() << std::endl;
+  }
 
   return 0;
 }
@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: Copyright (c) Stanford University, The Regents of the
+// University of California, and others. SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file blood_vessel.cpp
+ * @brief Benchmark of the batched BloodVessel update_solution.
+ *
+ * Compares the per-block BloodVessel::update_solution with the batched
+ * BloodVesselBatch::update_solution for all vessels of a model and checks
+ * that both give bit-identical contributions. Usage:
+ *
+ *     benchmark_blood_vessel <path_to_json_file> [num_calls]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Model.h"
+#include "SimulationParameters.h"
+#include "SparseSystem.h"
+
+// Check if two vectors of doubles have the same bit patterns
+bool bit_identical(const double* a, const double* b, int size) {
+  return std::memcmp(a, b, size * sizeof(double)) == 0;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    throw std::runtime_error(
+        "Usage: benchmark_blood_vessel <path_to_json_file> [num_calls]");
+  }
+  int num_calls = (argc > 2) ? std::stoi(argv[2]) : 10000;
+
+  std::ifstream input_file(argv[1]);
+  const auto config = nlohmann::json::parse(input_file);
+  Model model;
+  load_simulation_model(config, model);
+
+  std::vector<BloodVessel*> vessels;
+  for (int i = 0; i < model.get_num_blocks(); i++) {
+    if (auto vessel = dynamic_cast<BloodVessel*>(model.get_block(i))) {
+      vessels.push_back(vessel);
+    }
+  }
+  if (vessels.empty()) {
+    throw std::runtime_error("Model has no BloodVessel blocks");
+  }
+  BloodVesselBatch batch;
+  batch.setup(vessels);
+
+  // Solution with positive, negative and zero flows
+  int size = model.dofhandler.size();
+  Eigen::Matrix<double, Eigen::Dynamic, 1> y(size), dy(size);
+  for (int i = 0; i < size; i++) {
+    y[i] = (i % 7 == 0) ? 0.0 : 100.0 * std::sin(0.37 * i);
+    dy[i] = 10.0 * std::cos(0.91 * i);
+  }
+
+  // Parameter values up to the largest parameter ID of the vessels
+  int num_params = 0;
+  for (auto vessel : vessels) {
+    for (int param_id : vessel->global_param_ids) {
+      num_params = std::max(num_params, param_id + 1);
+    }
+  }
+  std::vector<double> parameters(num_params);
+  for (int i = 0; i < num_params; i++) {
+    parameters[i] = model.get_parameter_value(i);
+  }
+
+  SparseSystem scalar_system(size);
+  SparseSystem batch_system(size);
+  scalar_system.reserve(&model);
+  batch_system.reserve(&model);
+
+  auto run_scalar = [&]() {
+    for (auto vessel : vessels) {
+      vessel->BloodVessel::update_solution(scalar_system, parameters, y, dy);
+    }
+  };
+  auto run_batch = [&]() {
+    batch.update_solution(batch_system, parameters, y, dy);
+  };
+
+  // Check that both paths give the same contributions
+  run_scalar();
+  run_batch();
+  int nnz = scalar_system.dC_dy.nonZeros();
+  bool identical =
+      bit_identical(scalar_system.C.data(), batch_system.C.data(), size) &&
+      bit_identical(scalar_system.dC_dy.valuePtr(),
+                    batch_system.dC_dy.valuePtr(), nnz) &&
+      bit_identical(scalar_system.dC_dydot.valuePtr(),
+                    batch_system.dC_dydot.valuePtr(), nnz);
+
+  // Time both paths
+  auto time_calls = [&](auto&& call) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_calls; i++) {
+      call();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return 1.0e6 * std::chrono::duration<double>(stop - start).count() /
+           num_calls;
+  };
+  double scalar_time = time_calls(run_scalar);
+  double batch_time = time_calls(run_batch);
+
+  std::cout << "Number of vessels:  " << vessels.size() << std::endl;
+  std::cout << "Number of calls:    " << num_calls << std::endl;
+  std::cout << "Scalar [us]:        " << scalar_time << std::endl;
+  std::cout << "Batched [us]:       " << batch_time << std::endl;
+  std::cout << "Bit-identical:      " << (identical ? "yes" : "no")
+            << std::endl;
+
+  return identical ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+// SPDX-FileCopyrightText: Copyright (c) Stanford University, The Regents of the
+// University of California, and others. SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file integrator.cpp
+ * @brief Benchmark of the generalized-alpha and Rosenbrock integrators.
+ *
+ * Integrates the cardiac cycles of a model with both integrators for a range
+ * of time steps per cycle and prints the wall time and the error of the last
+ * cycle relative to a fine generalized-alpha solution (maximum over the
+ * degrees-of-freedom of the maximum error divided by the maximum magnitude).
+ * The wall time at equal accuracy follows from the two tables. Usage:
+ *
+ *     benchmark_integrator <path_to_json_file> [num_cycles]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Integrator.h"
+#include "Model.h"
+#include "RosenbrockIntegrator.h"
+#include "SimulationParameters.h"
+
+// Solution of the last cycle (one column per time step)
+using CycleSolution = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>;
+
+// Integrate num_cycles cycles with num_steps time steps each and return the
+// last cycle
+CycleSolution integrate(
+    Model& model, const State& initial_state, int num_cycles, int num_steps,
+    const std::function<State(const State&, double)>& step) {
+  double time_step_size = model.cardiac_cycle_period / num_steps;
+  CycleSolution cycle(model.dofhandler.size(), num_steps + 1);
+  State state = initial_state;
+  for (int i = 0; i < num_cycles * num_steps; i++) {
+    int j = i - (num_cycles - 1) * num_steps;
+    if (j >= 0) {
+      cycle.col(j) = state.y;
+    }
+    state = step(state, time_step_size * double(i));
+  }
+  cycle.col(num_steps) = state.y;
+  return cycle;
+}
+
+// Maximum error of a cycle relative to the reference (every ratio-th time
+// step of the reference)
+double relative_error(const CycleSolution& cycle,
+                      const CycleSolution& reference, int ratio) {
+  double error = 0.0;
+  for (int i = 0; i < cycle.rows(); i++) {
+    double scale = reference.row(i).cwiseAbs().maxCoeff();
+    if (scale < 1.0e-10) {
+      continue;
+    }
+    for (int j = 0; j < cycle.cols(); j++) {
+      error = std::max(
+          error, std::abs(cycle(i, j) - reference(i, j * ratio)) / scale);
+    }
+  }
+  return error;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    throw std::runtime_error(
+        "Usage: benchmark_integrator <path_to_json_file> [num_cycles]");
+  }
+
+  std::ifstream input_file(argv[1]);
+  const auto config = nlohmann::json::parse(input_file);
+  auto simparams = load_simulation_params(config);
+  Model model;
+  load_simulation_model(config, model);
+  State initial_state = load_initial_condition(config, model);
+  model.setup_initial_state_dependent_parameters(initial_state);
+  int num_cycles =
+      (argc > 2) ? std::stoi(argv[2]) : std::max(simparams.sim_num_cycles, 1);
+
+  // Time steps per cycle (the reference has 8 times the finest resolution)
+  const std::vector<int> num_steps_list = {25, 50, 100, 200, 400};
+  const int num_steps_reference = 3200;
+
+  auto generalized_alpha = [&](int num_steps) {
+    double time_step_size = model.cardiac_cycle_period / num_steps;
+    model.enable_time_tables(time_step_size, 0.0);
+    Integrator integrator(&model, time_step_size, simparams.sim_rho_infty,
+                          simparams.sim_abs_tol, simparams.sim_nliter);
+    return integrate(model, initial_state, num_cycles, num_steps,
+                     [&](const State& state, double time) {
+                       return integrator.step(state, time);
+                     });
+  };
+  auto rosenbrock = [&](int num_steps) {
+    double time_step_size = model.cardiac_cycle_period / num_steps;
+    model.enable_time_tables(time_step_size, 0.0);
+    RosenbrockIntegrator integrator(&model, time_step_size, 0.0,
+                                    time_step_size);
+    return integrate(model, initial_state, num_cycles, num_steps,
+                     [&](const State& state, double time) {
+                       return integrator.step(state, time);
+                     });
+  };
+
+  std::cout << "System size:      " << model.dofhandler.size() << std::endl;
+  std::cout << "Number of cycles: " << num_cycles << std::endl;
+  CycleSolution reference = generalized_alpha(num_steps_reference);
+
+  auto run = [&](const std::string& name,
+                 const std::function<CycleSolution(int)>& integrate_cycles) {
+    std::cout << std::endl << name << std::endl;
+    std::cout << "  steps/cycle   time [ms]   error" << std::endl;
+    for (int num_steps : num_steps_list) {
+      auto start = std::chrono::steady_clock::now();
+      CycleSolution cycle = integrate_cycles(num_steps);
+      auto stop = std::chrono::steady_clock::now();
+      double total = std::chrono::duration<double>(stop - start).count();
+      double error =
+          relative_error(cycle, reference, num_steps_reference / num_steps);
+      char line[80];
+      std::snprintf(line, sizeof(line), "  %11d %11.3f   %.2e", num_steps,
+                    1.0e3 * total, error);
+      std::cout << line << std::endl;
+    }
+  };
+  run("generalized_alpha", generalized_alpha);
+  run("rosenbrock", rosenbrock);
+}
@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: Copyright (c) Stanford University, The Regents of the
+// University of California, and others. SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file interface.cpp
+ * @brief Benchmark of the cost per call of the interface increment_time.
+ *
+ * This mimics an external 3D solver that advances the 0D model by one time
+ * step per call. Usage:
+ *
+ *     benchmark_interface <path_to_json_file> [num_calls]
+ */
+
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+extern "C" void initialize(std::string input_file, int& problem_id,
+                           int& pts_per_cycle, int& num_cycles,
+                           int& num_output_steps,
+                           std::vector<std::string>& block_names,
+                           std::vector<std::string>& variable_names);
+
+extern "C" void set_external_step_size(int problem_id,
+                                       double external_step_size);
+
+extern "C" void increment_time(int problem_id, const double external_time,
+                               std::vector<double>& solution);
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    throw std::runtime_error(
+        "Usage: benchmark_interface <path_to_json_file> [num_calls]");
+  }
+  int num_calls = (argc > 2) ? std::stoi(argv[2]) : 10000;
+
+  int problem_id = 0;
+  int pts_per_cycle = 0;
+  int num_cycles = 0;
+  int num_output_steps = 0;
+  std::vector<std::string> block_names;
+  std::vector<std::string> variable_names;
+  initialize(argv[1], problem_id, pts_per_cycle, num_cycles, num_output_steps,
+             block_names, variable_names);
+
+  double external_step_size = 1.0e-3;
+  set_external_step_size(problem_id, external_step_size);
+
+  std::vector<double> solution(variable_names.size());
+  double time = 0.0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_calls; i++) {
+    increment_time(problem_id, time, solution);
+    time += external_step_size;
+  }
+  auto stop = std::chrono::steady_clock::now();
+  double total = std::chrono::duration<double>(stop - start).count();
+
+  std::cout << "System size:        " << variable_names.size() << std::endl;
+  std::cout << "Number of calls:    " << num_calls << std::endl;
+  std::cout << "Total time [s]:     " << total << std::endl;
+  std::cout << "Time per call [us]: " << 1.0e6 * total / num_calls
+            << std::endl;
+}
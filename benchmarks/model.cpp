@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: Copyright (c) Stanford University, The Regents of the
+// University of California, and others. SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file model.cpp
+ * @brief Benchmark of the cost per call of the block evaluation in Model.
+ *
+ * Times Model::update_time, Model::update_solution and Model::post_solve on
+ * the system of a model, i.e. the block evaluations in every time step and
+ * non-linear iteration without the linear solve. Usage:
+ *
+ *     benchmark_model <path_to_json_file> [num_calls]
+ */
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "Model.h"
+#include "SimulationParameters.h"
+#include "SparseSystem.h"
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    throw std::runtime_error(
+        "Usage: benchmark_model <path_to_json_file> [num_calls]");
+  }
+  int num_calls = (argc > 2) ? std::stoi(argv[2]) : 10000;
+
+  std::ifstream input_file(argv[1]);
+  const auto config = nlohmann::json::parse(input_file);
+  Model model;
+  load_simulation_model(config, model);
+  State state = load_initial_condition(config, model);
+
+  int size = model.dofhandler.size();
+  SparseSystem system(size);
+  system.reserve(&model);
+
+  // Time each block hook separately
+  auto time_calls = [&](const std::string& name, auto&& call) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_calls; i++) {
+      call(i);
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double total = std::chrono::duration<double>(stop - start).count();
+    std::cout << name << " [us]: " << 1.0e6 * total / num_calls << std::endl;
+  };
+
+  std::cout << "System size:     " << size << std::endl;
+  std::cout << "Number of blocks: " << model.get_num_blocks() << std::endl;
+  std::cout << "Number of calls: " << num_calls << std::endl;
+  time_calls("update_time    ",
+             [&](int i) { model.update_time(system, 1.0e-3 * i); });
+  time_calls("update_solution", [&](int i) {
+    model.update_solution(system, state.y, state.ydot);
+  });
+  time_calls("post_solve     ", [&](int i) { model.post_solve(state.y); });
+}
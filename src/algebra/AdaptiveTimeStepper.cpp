@@ -0,0 +1,216 @@
+// SPDX-FileCopyrightText: Copyright (c) Stanford University, The Regents of the
+// University of California, and others. SPDX-License-Identifier: BSD-3-Clause
+
+#include "AdaptiveTimeStepper.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+// Evaluate the quadratic polynomial through (t0, y0), (t1, y1), (t2, y2) at a
+// time (Newton form, evaluated coefficient-wise without temporaries)
+static void quadratic(double t0,
+                      const Eigen::Matrix<double, Eigen::Dynamic, 1>& y0,
+                      double t1,
+                      const Eigen::Matrix<double, Eigen::Dynamic, 1>& y1,
+                      double t2,
+                      const Eigen::Matrix<double, Eigen::Dynamic, 1>& y2,
+                      double time,
+                      Eigen::Matrix<double, Eigen::Dynamic, 1>& y) {
+  auto slope_01 = (y1 - y0) / (t1 - t0);
+  auto slope_12 = (y2 - y1) / (t2 - t1);
+  y = y2 + (time - t2) * slope_12 +
+      (time - t2) * (time - t1) * (slope_12 - slope_01) / (t2 - t0);
+}
+
+AdaptiveTimeStepper::AdaptiveTimeStepper(Integrator* integrator,
+                                         double tolerance,
+                                         double min_time_step_size,
+                                         double max_time_step_size,
+                                         double period)
+    : integrator(integrator),
+      tolerance(tolerance),
+      min_time_step_size(min_time_step_size),
+      max_time_step_size(max_time_step_size),
+      period(period) {
+  if ((min_time_step_size <= 0.0) ||
+      (max_time_step_size < min_time_step_size)) {
+    throw std::runtime_error(
+        "Invalid bounds of the adaptive time step size [" +
+        std::to_string(min_time_step_size) + ", " +
+        std::to_string(max_time_step_size) + "]");
+  }
+  time_step_size = std::clamp(integrator->get_time_step_size(),
+                              min_time_step_size, max_time_step_size);
+}
+
+AdaptiveTimeStepper::AdaptiveTimeStepper() {}
+
+void AdaptiveTimeStepper::reset(const State& state, double time) {
+  if ((num_steps > 0) && (state.y == state_new.y) &&
+      (state.ydot == state_new.ydot)) {
+    double shift = time - time_new;
+    time_older += shift;
+    time_old += shift;
+    time_new = time;
+    return;
+  }
+  state_old = state;
+  state_new = state;
+  if (state_step.y.size() != state.y.size()) {
+    state_step = State::Zero(state.y.size());
+  }
+  time_old = time;
+  time_new = time;
+  num_history = 0;
+  if (y_scale.size() == 0) {
+    y_scale = state.y.cwiseAbs();
+  } else {
+    y_scale = y_scale.cwiseMax(state.y.cwiseAbs());
+  }
+}
+
+State AdaptiveTimeStepper::advance(double time) {
+  State state = State::Zero(state_new.y.size());
+  advance(time, state);
+  return state;
+}
+
+void AdaptiveTimeStepper::advance(double time, State& state) {
+  double eps = 1.0e-10 * min_time_step_size;
+  if (time < time_old - eps) {
+    throw std::runtime_error("Adaptive time stepping can't go back to time " +
+                             std::to_string(time));
+  }
+  while (time_new < time - eps) {
+    take_step();
+  }
+  if (time >= time_new - eps) {
+    state.y = state_new.y;
+    state.ydot = state_new.ydot;
+    return;
+  }
+
+  // Interpolate within the last step
+  double theta = (time - time_old) / (time_new - time_old);
+  polynomial(time, state.y);
+  state.ydot = (1.0 - theta) * state_old.ydot + theta * state_new.ydot;
+}
+
+void AdaptiveTimeStepper::take_step() {
+  // End the step on the next boundary of a cardiac cycle
+  double step = std::min(time_step_size, max_time_step_size);
+  double time_end = time_new + step;
+  bool at_boundary = false;
+  if (period > 0.0) {
+    double boundary =
+        (std::floor(time_new / period + 1.0e-10) + 1.0) * period;
+    if (time_end >= boundary - 0.01 * step) {
+      time_end = boundary;
+      step = boundary - time_new;
+      at_boundary = true;
+    }
+  }
+
+  bool rejected = false;
+  while (true) {
+    integrator->set_time_step_size(step);
+
+    // Reduce the time step size if the non-linear iterations fail
+    try {
+      integrator->step(state_new, state_step, time_new);
+    } catch (const std::runtime_error&) {
+      if (step <= min_time_step_size) {
+        throw;
+      }
+      num_rejected_steps++;
+      step = std::max(0.25 * step, min_time_step_size);
+      time_end = time_new + step;
+      at_boundary = false;
+      continue;
+    }
+
+    // Keep the time step size without an error estimate (right after a
+    // restart)
+    double scaled_error = estimate_error(state_step, step);
+    double factor = 1.0;
+    if (scaled_error >= 0.0) {
+      factor = std::clamp(
+          0.9 * std::pow(std::max(scaled_error, 1.0e-10), -1.0 / 3.0), 0.2,
+          2.0);
+    }
+    if ((scaled_error > 1.0) && (step > min_time_step_size)) {
+      num_rejected_steps++;
+      rejected = true;
+      step = std::max(step * factor, min_time_step_size);
+      time_end = time_new + step;
+      at_boundary = false;
+      continue;
+    }
+
+    // Accept the step (the states rotate through the preallocated buffers)
+    if (num_history > 0) {
+      y_older = state_old.y;
+      time_older = time_old;
+    }
+    num_history = std::min(num_history + 1, 2);
+    state_old.swap(state_new);
+    state_new.swap(state_step);
+    time_old = time_new;
+    time_new = time_end;
+    y_scale = y_scale.cwiseMax(state_new.y.cwiseAbs());
+    num_steps++;
+
+    // A step shortened to end on a cycle boundary doesn't limit the next one
+    if (rejected) {
+      factor = std::min(factor, 1.0);
+    }
+    double next_step = step * factor;
+    if (at_boundary && (factor >= 1.0)) {
+      next_step = std::max(next_step, time_step_size);
+    }
+    time_step_size =
+        std::clamp(next_step, min_time_step_size, max_time_step_size);
+    return;
+  }
+}
+
+double AdaptiveTimeStepper::estimate_error(const State& state,
+                                           double time_step_size) {
+  if (num_history < 2) {
+    return -1.0;
+  }
+
+  // Milne's device, filtered with the Jacobian of the step (which also gives
+  // the error of the algebraic degrees-of-freedom)
+  double error_constant = integrator->get_error_constant();
+  polynomial(time_new + time_step_size, error);
+  error = (error_constant / (1.0 + error_constant)) * (state.y - error);
+  integrator->filter_error(error, filtered_error);
+  error_scale = y_scale.cwiseMax(state.y.cwiseAbs());
+  double scale_floor = std::max(1.0e-6 * error_scale.maxCoeff(), 1.0e-12);
+  error_scale = error_scale.cwiseMax(scale_floor);
+  filtered_error = filtered_error.cwiseQuotient(error_scale);
+  return std::sqrt(filtered_error.squaredNorm() / filtered_error.size()) /
+         tolerance;
+}
+
+void AdaptiveTimeStepper::polynomial(
+    double time, Eigen::Matrix<double, Eigen::Dynamic, 1>& y) const {
+  if (num_history == 0) {
+    y = state_new.y;
+  } else if (num_history == 1) {
+    y = state_new.y + (time - time_new) * (state_new.y - state_old.y) /
+                          (time_new - time_old);
+  } else {
+    quadratic(time_older, y_older, time_old, state_old.y, time_new,
+              state_new.y, time, y);
+  }
+}
+
+int AdaptiveTimeStepper::get_num_steps() const { return num_steps; }
+
+int AdaptiveTimeStepper::get_num_rejected_steps() const {
+  return num_rejected_steps;
+}
@@ -0,0 +1,170 @@
+// SPDX-FileCopyrightText: Copyright (c) Stanford University, The Regents of the
+// University of California, and others. SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file AdaptiveTimeStepper.h
+ * @brief AdaptiveTimeStepper source file
+ */
+#ifndef SVZERODSOLVER_ALGEBRA_ADAPTIVETIMESTEPPER_HPP_
+#define SVZERODSOLVER_ALGEBRA_ADAPTIVETIMESTEPPER_HPP_
+
+#include <Eigen/Dense>
+
+#include "Integrator.h"
+#include "State.h"
+
+/**
+ * @brief Adaptive time stepping for the generalized-alpha integrator
+ *
+ * The time step size is controlled with an estimate of the local truncation
+ * error of the solution \f$y\f$. The error of a step from \f$t_n\f$ to
+ * \f$t_{n+1}\f$ is estimated by comparing the solution of the (second-order)
+ * generalized-\f$\alpha\f$ step with the quadratic extrapolation
+ * \f$y^p_{n+1}\f$ of the solutions at \f$t_{n-2}\f$, \f$t_{n-1}\f$, and
+ * \f$t_n\f$ (Milne's device):
+ *
+ * \f[
+ * e_{n+1} = \frac{C}{1 + C} \left(y_{n+1} - y^p_{n+1}\right),
+ * \f]
+ *
+ * where \f$C\f$ is the error coefficient of the integrator (see
+ * Integrator::get_error_constant, \f$C / (1 + C) = 1/10\f$ for the default
+ * \f$\rho_{\infty} = 0.5\f$) and \f$-1\f$ that of the extrapolation for
+ * constant time steps. The estimate is filtered with the Jacobian of the
+ * step (see Integrator::filter_error). The algebraic degrees-of-freedom are
+ * determined by the differential ones at the generalized mid-point and
+ * their values oscillate with the damping of the integrator after every
+ * change of the time step size, which would make their own extrapolation
+ * reject steps in a feedback loop. The filter replaces their estimate with
+ * the error caused by that of the differential degrees-of-freedom.
+ *
+ * The root mean square of the error is taken after scaling each component
+ * with its maximum absolute value so far. A step with a scaled error larger
+ * than the tolerance is rejected and repeated with a smaller time step size.
+ * The next time step size is \f$\Delta t_{n+1} = \Delta t_n \min(2,
+ * \max(0.2, 0.9 \epsilon^{-1/3}))\f$, where \f$\epsilon\f$ is the ratio of
+ * the error to the tolerance, limited to the given bounds (and not increased
+ * after a rejected step). Steps end on the boundaries of the cardiac cycles.
+ *
+ * The solution at arbitrary times (e.g. the output times) within the last
+ * step is interpolated quadratically from the solutions at the last three
+ * time steps (dense output). \f$\dot{y}\f$ is interpolated linearly.
+ */
+class AdaptiveTimeStepper {
+ public:
+  /**
+   * @brief Construct a new AdaptiveTimeStepper object
+   *
+   * @param integrator Integrator performing the time steps
+   * @param tolerance Tolerance of the scaled local truncation error
+   * @param min_time_step_size Minimum time step size
+   * @param max_time_step_size Maximum time step size
+   * @param period Cardiac cycle period (steps end on the cycle boundaries)
+   */
+  AdaptiveTimeStepper(Integrator* integrator, double tolerance,
+                      double min_time_step_size, double max_time_step_size,
+                      double period);
+
+  /**
+   * @brief Construct a new AdaptiveTimeStepper object
+   *
+   */
+  AdaptiveTimeStepper();
+
+  /**
+   * @brief Restart the time stepping from a state
+   *
+   * Keeps the current time step size. The step history of the error
+   * estimate is discarded unless the state is the one at the end of the last
+   * step (e.g. when only the time is shifted by a cardiac cycle).
+   *
+   * @param state State
+   * @param time Time of the state
+   */
+  void reset(const State& state, double time);
+
+  /**
+   * @brief Advance the solution to a time
+   *
+   * Performs time steps until the given time is reached and interpolates the
+   * solution at the given time within the last step.
+   *
+   * @param time Time (not before the start of the last step)
+   * @return State Solution at the given time
+   */
+  State advance(double time);
+
+  /**
+   * @brief Advance the solution to a time in place (see advance)
+   *
+   * The solution is written into a preallocated state (of the size of the
+   * model). Together with the work vectors of the time stepper and the
+   * integrator, the time steps don't allocate memory (apart from the
+   * factorizations of the linear solver and the repetition of steps whose
+   * non-linear iterations fail).
+   *
+   * @param time Time (not before the start of the last step)
+   * @param state Solution at the given time
+   */
+  void advance(double time, State& state);
+
+  /**
+   * @brief Get the number of accepted time steps
+   *
+   * @return int Number of accepted time steps
+   */
+  int get_num_steps() const;
+
+  /**
+   * @brief Get the number of rejected time steps
+   *
+   * @return int Number of rejected time steps
+   */
+  int get_num_rejected_steps() const;
+
+ private:
+  /// Perform one accepted time step
+  void take_step();
+
+  /**
+   * @brief Get the scaled local truncation error of a step from
+   * `state_new` relative to the tolerance
+   *
+   * @param state Solution at the end of the step
+   * @param time_step_size Time step size
+   * @return double Scaled error (accept if not larger than one)
+   */
+  double estimate_error(const State& state, double time_step_size);
+
+  /**
+   * @brief Extrapolate or interpolate the solution from the last three time
+   * steps (or fewer, if not available)
+   *
+   * @param time Time
+   * @param y Solution at the time
+   */
+  void polynomial(double time,
+                  Eigen::Matrix<double, Eigen::Dynamic, 1>& y) const;
+
+  Integrator* integrator{nullptr};
+  double tolerance{0.0};
+  double min_time_step_size{0.0};
+  double max_time_step_size{0.0};
+  double period{0.0};
+  double time_step_size{0.0};
+  double time_older{0.0};
+  double time_old{0.0};
+  double time_new{0.0};
+  int num_history{0};
+  Eigen::Matrix<double, Eigen::Dynamic, 1> y_older;
+  State state_old;
+  State state_new;
+  State state_step;
+  Eigen::Matrix<double, Eigen::Dynamic, 1> y_scale;
+  Eigen::Matrix<double, Eigen::Dynamic, 1> error;
+  Eigen::Matrix<double, Eigen::Dynamic, 1> filtered_error;
+  Eigen::Matrix<double, Eigen::Dynamic, 1> error_scale;
+  int num_steps{0};
+  int num_rejected_steps{0};
+};
+
+#endif  // SVZERODSOLVER_ALGEBRA_ADAPTIVETIMESTEPPER_HPP_
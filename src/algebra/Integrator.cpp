@@ -3,8 +3,16 @@
 
 #include "Integrator.h"
 
+#include <algorithm>
+#include <cmath>
+
 Integrator::Integrator(Model* model, double time_step_size, double rho,
-                       double atol, int max_iter) {
+                       double atol, int max_iter,
+                       const std::string& linear_solver,
+                       const std::string& ordering, int jacobian_reuse_steps,
+                       double jacobian_reuse_rate, bool event_detection,
+                       bool line_search, int max_step_halvings,
+                       const std::string& predictor) {
   this->model = model;
   alpha_m = 0.5 * (3.0 - rho) / (1.0 + rho);
   alpha_f = 1.0 / (1.0 + rho);
@@ -15,13 +23,37 @@ Integrator::Integrator(Model* model, double time_step_size, double rho,
   y_coeff_jacobian = alpha_f * y_coeff;
 
   size = model->dofhandler.size();
+  linear_time_invariant = model->is_linear_time_invariant();
   system = SparseSystem(size);
+  system.solver = create_linear_solver(linear_solver, ordering);
   this->time_step_size = time_step_size;
   this->atol = atol;
   this->max_iter = max_iter;
+  this->jacobian_reuse_steps = jacobian_reuse_steps;
+  this->jacobian_reuse_rate = jacobian_reuse_rate;
+  this->event_detection =
+      event_detection && (model->get_num_switching_functions() > 0);
+  this->line_search = line_search;
+  this->max_step_halvings = max_step_halvings;
+  if (predictor == "constant") {
+    this->predictor = Predictor::constant;
+  } else if (predictor == "extrapolate2") {
+    this->predictor = Predictor::extrapolate2;
+  } else if (predictor == "extrapolate3") {
+    this->predictor = Predictor::extrapolate3;
+  } else if (predictor == "periodic") {
+    this->predictor = Predictor::periodic;
+  } else {
+    throw std::runtime_error(
+        "Invalid predictor " + predictor +
+        ". Options are constant, extrapolate2, extrapolate3, periodic.");
+  }
 
   y_af = Eigen::Matrix<double, Eigen::Dynamic, 1>(size);
   ydot_am = Eigen::Matrix<double, Eigen::Dynamic, 1>(size);
+  increment = Eigen::Matrix<double, Eigen::Dynamic, 1>(size);
+  error_rhs = Eigen::Matrix<double, Eigen::Dynamic, 1>(size);
+  history_y = Eigen::Matrix<double, Eigen::Dynamic, 3>(size, 3);
 
   // Make some memory reservations
   system.reserve(model);
@@ -42,15 +74,198 @@ void Integrator::update_params(double time_step_size) {
   this->time_step_size = time_step_size;
   y_coeff = gamma * time_step_size;
   y_coeff_jacobian = alpha_f * y_coeff;
+  jacobian_factorized = false;
+  factorized_time_step_size = 0.0;
+  linear_time_invariant = model->is_linear_time_invariant();
   model->update_constant(system);
   model->update_time(system, 0.0);
 }
 
+void Integrator::reset() {
+  system.reset(model);
+  system.solver->reset_statistics();
+  jacobian_factorized = false;
+  factorized_time_step_size = 0.0;
+  jacobian_age = 0;
+  n_iter = 0;
+  n_nonlin_iter = 0;
+  n_saved_factorizations = 0;
+  n_events = 0;
+  n_backtracks = 0;
+  n_rejected_steps = 0;
+  num_history = 0;
+  last_phase = 0.0;
+  cycle_history.clear();
+  event_y.resize(0);
+}
+
+void Integrator::set_time_step_size(double time_step_size) {
+  if (time_step_size == this->time_step_size) {
+    return;
+  }
+  this->time_step_size = time_step_size;
+  y_coeff = gamma * time_step_size;
+  y_coeff_jacobian = alpha_f * y_coeff;
+  jacobian_factorized = false;
+}
+
+double Integrator::get_time_step_size() const { return time_step_size; }
+
 State Integrator::step(const State& old_state, double time) {
-  // Predictor: Constant y, consistent ydot
   State new_state = State::Zero(size);
-  new_state.ydot += old_state.ydot * ydot_init_coeff;
-  new_state.y += old_state.y;
+  step(old_state, new_state, time);
+  return new_state;
+}
+
+void Integrator::step(const State& old_state, State& new_state, double time) {
+  if (new_state.y.size() != size) {
+    new_state = State::Zero(size);
+  }
+  if (!event_detection) {
+    solve_step(old_state, time, new_state);
+    update_history(old_state, time, new_state, time + time_step_size);
+    return;
+  }
+
+  // Maximum number of events in one step (the remaining events are treated
+  // in the next step), maximum number of iterations to locate an event, and
+  // tolerance of its time relative to the time step size
+  const int max_step_events = 10;
+  const int max_locate_iter = 10;
+  const double event_tol = 1.0e-3;
+
+  // The sub-steps between the events start from `event_state`
+  double step_size = time_step_size;
+  double time_start = time;
+  double time_end = time + step_size;
+  State& state = event_state;
+  State& trial_state = event_trial_state;
+  state = old_state;
+  if (trial_state.y.size() != size) {
+    trial_state = State::Zero(size);
+  }
+  model->freeze_discrete_states = true;
+
+  // Keep the discrete states of the last step when continuing from its end
+  // (setting them from the solution could undo a switch, e.g. from a small
+  // residual flow through a closed valve)
+  if ((state.y.size() != event_y.size()) || (state.y != event_y)) {
+    model->update_discrete_states(state.y);
+  }
+  try {
+    for (int num_step_events = 0;; num_step_events++) {
+      model->get_switching_functions(state.y, switching_old);
+      double remaining = time_end - time;
+      set_time_step_size(remaining);
+      solve_step(state, time, new_state);
+      if (!has_event(new_state)) {
+        break;
+      }
+      if (num_step_events == max_step_events) {
+        model->update_discrete_states(new_state.y);
+        break;
+      }
+
+      // Locate the first sign change in the bracket [lower, upper] (fractions
+      // of the remaining step)
+      double lower = 0.0;
+      double upper = 1.0;
+      switching_lower = switching_old;
+      switching_upper = switching_new;
+      for (int i = 0; (i < max_locate_iter) &&
+                      ((upper - lower) * remaining > event_tol * step_size);
+           i++) {
+        double theta = upper;
+        for (size_t j = 0; j < switching_old.size(); j++) {
+          if ((switching_upper[j] > 0.0) != (switching_old[j] > 0.0)) {
+            theta = std::min(
+                theta, lower + (upper - lower) * switching_lower[j] /
+                                   (switching_lower[j] - switching_upper[j]));
+          }
+        }
+        theta = std::clamp(theta, lower + 0.1 * (upper - lower),
+                           upper - 0.1 * (upper - lower));
+        set_time_step_size(theta * remaining);
+        solve_step(state, time, trial_state);
+        if (has_event(trial_state)) {
+          upper = theta;
+          switching_upper = switching_new;
+          new_state.swap(trial_state);
+        } else {
+          lower = theta;
+          switching_lower = switching_new;
+        }
+      }
+
+      // Continue after the event with the switched discrete states
+      n_events++;
+      model->update_discrete_states(new_state.y);
+      if (upper == 1.0) {
+        break;
+      }
+      time += upper * remaining;
+      state.swap(new_state);
+    }
+  } catch (const std::runtime_error&) {
+    model->freeze_discrete_states = false;
+    set_time_step_size(step_size);
+    throw;
+  }
+  model->freeze_discrete_states = false;
+  set_time_step_size(step_size);
+  event_y = new_state.y;
+  update_history(old_state, time_start, new_state, time_end);
+}
+
+bool Integrator::has_event(const State& state) {
+  model->get_switching_functions(state.y, switching_new);
+  for (size_t i = 0; i < switching_new.size(); i++) {
+    if ((switching_new[i] > 0.0) != (switching_old[i] > 0.0)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Integrator::solve_step(const State& old_state, double time,
+                            State& new_state, int num_halvings) {
+  if (num_halvings >= max_step_halvings) {
+    newton_step(old_state, time, new_state);
+    return;
+  }
+  try {
+    newton_step(old_state, time, new_state);
+    return;
+  } catch (const std::runtime_error&) {
+    n_rejected_steps++;
+  }
+
+  // Repeat the rejected step as two steps of half the size
+  double step_size = time_step_size;
+  set_time_step_size(0.5 * step_size);
+  try {
+    State half_state = State::Zero(size);
+    solve_step(old_state, time, half_state, num_halvings + 1);
+    solve_step(half_state, time + 0.5 * step_size, new_state,
+               num_halvings + 1);
+  } catch (const std::runtime_error&) {
+    set_time_step_size(step_size);
+    throw;
+  }
+  set_time_step_size(step_size);
+}
+
+void Integrator::newton_step(const State& old_state, double time,
+                             State& new_state, bool use_predictor) {
+  // Predictor: Constant or predicted y, consistent ydot (the corrector keeps
+  // y - gamma * dt * ydot constant)
+  bool predicted = use_predictor && predict(old_state, time, new_state.y);
+  new_state.ydot = old_state.ydot * ydot_init_coeff;
+  if (predicted) {
+    new_state.ydot += (new_state.y - old_state.y) / y_coeff;
+  } else {
+    new_state.y = old_state.y;
+  }
 
   // Determine new time (evaluate terms at generalized mid-point)
   double new_time = time + alpha_f * time_step_size;
@@ -58,37 +273,79 @@ State Integrator::step(const State& old_state, double time) {
   // Evaluate time-dependent element contributions in system
   model->update_time(system, new_time);
 
-  // Count total number of step calls
-  n_iter++;
+  // Count total number of step calls (once if the predictor is discarded)
+  if (use_predictor) {
+    n_iter++;
+  }
+
+  // Discard reused factorization of the Jacobian after the maximum number of
+  // time steps (the Jacobian of linear time-invariant models is constant)
+  if (!linear_time_invariant && (jacobian_age++ >= jacobian_reuse_steps)) {
+    jacobian_factorized = false;
+  }
+  double residual_norm_old = 0.0;
+  bool residual_updated = false;
 
   // Non-linear Newton-Raphson iterations
   for (size_t i = 0; i < max_iter; i++) {
-    // Initiator: Evaluate the iterates at the intermediate time levels
-    ydot_am.setZero();
-    y_af.setZero();
-    ydot_am += old_state.ydot + (new_state.ydot - old_state.ydot) * alpha_m;
-    y_af += old_state.y + (new_state.y - old_state.y) * alpha_f;
+    // The line search already evaluated the residual of the current iterate
+    if (!residual_updated) {
+      // Initiator: Evaluate the iterates at the intermediate time levels
+      ydot_am.setZero();
+      y_af.setZero();
+      ydot_am += old_state.ydot + (new_state.ydot - old_state.ydot) * alpha_m;
+      y_af += old_state.y + (new_state.y - old_state.y) * alpha_f;
 
-    // Update solution-dependent element contribitions
-    model->update_solution(system, y_af, ydot_am);
+      // Update solution-dependent element contribitions (only once for
+      // linear time-invariant models, where they are zero)
+      if (!linear_time_invariant || !jacobian_factorized) {
+        model->update_solution(system, y_af, ydot_am);
+      }
 
-    // Evaluate residual
-    system.update_residual(y_af, ydot_am);
+      // Evaluate residual
+      system.update_residual(y_af, ydot_am);
+    }
+    residual_updated = false;
 
-    // Check termination criterium
-    if (system.residual.cwiseAbs().maxCoeff() < atol) {
+    // Check termination criterium (a predicted solution is always corrected
+    // at least once)
+    double residual_norm = system.residual.cwiseAbs().maxCoeff();
+    if ((residual_norm < atol) && !(predicted && (i == 0))) {
       break;
     }
 
-    // Abort if maximum number of non-linear iterations is reached
+    // Abort if maximum number of non-linear iterations is reached (retry
+    // from a constant solution if the predicted one failed)
     else if (i == max_iter - 1) {
+      if (predicted) {
+        newton_step(old_state, time, new_state, false);
+        return;
+      }
       throw std::runtime_error(
           "Maximum number of non-linear iterations reached at time " +
           std::to_string(time));
     }
 
-    // Evaluate Jacobian
-    system.update_jacobian(alpha_m, y_coeff_jacobian);
+    // Evaluate and factorize Jacobian unless the last factorization still
+    // reduces the residual fast enough, i.e. by the reuse rate and such that
+    // the tolerance is reached within the remaining iterations
+    bool refactorize = !jacobian_factorized;
+    if (!refactorize && !linear_time_invariant && (i > 0)) {
+      double rate = residual_norm / residual_norm_old;
+      refactorize =
+          (rate > jacobian_reuse_rate) ||
+          (residual_norm * std::pow(rate, double(max_iter - 1 - i)) >= atol);
+    }
+    if (refactorize) {
+      system.update_jacobian(alpha_m, y_coeff_jacobian);
+      system.factorize();
+      jacobian_factorized = linear_time_invariant || (jacobian_reuse_steps > 0);
+      factorized_time_step_size = time_step_size;
+      jacobian_age = 1;
+    } else {
+      n_saved_factorizations++;
+    }
+    residual_norm_old = residual_norm;
 
     // Solve system for increment in ydot
     system.solve();
@@ -97,16 +354,240 @@ State Integrator::step(const State& old_state, double time) {
     model->post_solve(new_state.y);
 
     // Update the solution
-    new_state.ydot += system.dydot;
-    new_state.y += system.dydot * y_coeff;
+    if (line_search && !linear_time_invariant) {
+      update_with_line_search(old_state, new_state);
+      residual_updated = true;
+    } else {
+      new_state.ydot += system.dydot;
+      new_state.y += system.dydot * y_coeff;
+    }
 
     // Count total number of nonlinear iterations
     n_nonlin_iter++;
+
+    // The increment is exact for linear time-invariant models
+    if (linear_time_invariant) {
+      break;
+    }
   }
+}
 
-  return new_state;
+void Integrator::update_with_line_search(const State& old_state,
+                                         State& new_state) {
+  // Minimum damping of the increment and sufficient decrease of the squared
+  // residual norm per unit damping (Armijo condition)
+  const double min_damping = 1.0 / 16.0;
+  const double sufficient_decrease = 1.0e-4;
+
+  double residual_norm = system.residual.squaredNorm();
+  increment = system.dydot;
+  for (double damping = 1.0;; damping *= 0.5) {
+    // Evaluate the residual of the damped update at the intermediate time
+    // levels
+    ydot_am.setZero();
+    y_af.setZero();
+    ydot_am +=
+        old_state.ydot +
+        (new_state.ydot + damping * increment - old_state.ydot) * alpha_m;
+    y_af += old_state.y +
+            (new_state.y + (damping * y_coeff) * increment - old_state.y) *
+                alpha_f;
+    model->update_solution(system, y_af, ydot_am);
+    system.update_residual(y_af, ydot_am);
+
+    // Take the smallest damping even without a sufficient decrease (the
+    // non-linear iterations or the time step may still fail)
+    if ((system.residual.squaredNorm() <=
+         (1.0 - sufficient_decrease * damping) * residual_norm) ||
+        (system.residual.cwiseAbs().maxCoeff() < atol) ||
+        (damping <= min_damping)) {
+      new_state.ydot += damping * increment;
+      new_state.y += (damping * y_coeff) * increment;
+      return;
+    }
+    n_backtracks++;
+  }
+}
+
+bool Integrator::predict(const State& state, double time,
+                         Eigen::Matrix<double, Eigen::Dynamic, 1>& y) {
+  if (predictor == Predictor::constant) {
+    return false;
+  }
+  double new_time = time + time_step_size;
+
+  // Interpolate the solution of the previous cardiac cycle between the
+  // neighboring phases (if they are close enough)
+  if ((predictor == Predictor::periodic) && (cycle_history.size() > 1)) {
+    double period = model->cardiac_cycle_period;
+    double phase = get_phase(new_time);
+    auto upper = std::lower_bound(
+        cycle_history.begin(), cycle_history.end(), phase,
+        [](const auto& entry, double value) { return entry.first < value; });
+    if (upper == cycle_history.end()) {
+      upper = cycle_history.begin();
+    }
+    auto lower =
+        (upper == cycle_history.begin()) ? cycle_history.end() : upper;
+    lower--;
+    double gap = upper->first - lower->first;
+    double offset = phase - lower->first;
+    if (gap <= 0.0) {
+      gap += period;
+    }
+    if (offset < 0.0) {
+      offset += period;
+    }
+    if (gap <= 3.0 * time_step_size) {
+      y = lower->second;
+      y += (std::min(offset / gap, 1.0)) * (upper->second - lower->second);
+      return true;
+    }
+  }
+
+  // Lagrange polynomial through the last time steps
+  if (!continues_history(state, time)) {
+    return false;
+  }
+  int num_points = std::min(num_history, 2);
+  if (predictor == Predictor::extrapolate3) {
+    num_points = num_history;
+  }
+  if (num_points < 2) {
+    return false;
+  }
+  y.setZero();
+  for (int i = 0; i < num_points; i++) {
+    double weight = 1.0;
+    for (int j = 0; j < num_points; j++) {
+      if (j != i) {
+        weight *= (new_time - history_time[j]) /
+                  (history_time[i] - history_time[j]);
+      }
+    }
+    y += weight * history_y.col(i);
+  }
+  return true;
+}
+
+void Integrator::update_history(const State& old_state, double time,
+                                const State& new_state, double new_time) {
+  if (predictor == Predictor::constant) {
+    return;
+  }
+
+  // Restart the history if the step doesn't continue it
+  if (!continues_history(old_state, time)) {
+    num_history = 1;
+    history_time[0] = time;
+    history_y.col(0) = old_state.y;
+    if (predictor == Predictor::periodic) {
+      update_cycle_history(old_state.y, time);
+    }
+  }
+  for (int i = std::min(num_history, 2); i > 0; i--) {
+    history_time[i] = history_time[i - 1];
+    history_y.col(i) = history_y.col(i - 1);
+  }
+  num_history = std::min(num_history + 1, 3);
+  history_time[0] = new_time;
+  history_y.col(0) = new_state.y;
+  if (predictor == Predictor::periodic) {
+    update_cycle_history(new_state.y, new_time);
+  }
+}
+
+void Integrator::update_cycle_history(
+    const Eigen::Matrix<double, Eigen::Dynamic, 1>& y, double time) {
+  double period = model->cardiac_cycle_period;
+  if (period <= 0.0) {
+    return;
+  }
+  double phase = get_phase(time);
+  double eps = 1.0e-6 * time_step_size;
+
+  // Remove the solutions of the previous cycle between the last phase and
+  // this one
+  if (!cycle_history.empty()) {
+    auto passed = [&](const auto& entry) {
+      if (last_phase <= phase) {
+        return (entry.first > last_phase + eps) &&
+               (entry.first < phase - eps);
+      }
+      return (entry.first > last_phase + eps) || (entry.first < phase - eps);
+    };
+    cycle_history.erase(
+        std::remove_if(cycle_history.begin(), cycle_history.end(), passed),
+        cycle_history.end());
+  }
+  last_phase = phase;
+
+  // Replace the solution at the same phase or insert it
+  auto it = std::lower_bound(
+      cycle_history.begin(), cycle_history.end(), phase - eps,
+      [](const auto& entry, double value) { return entry.first < value; });
+  if ((it != cycle_history.end()) && (it->first <= phase + eps)) {
+    it->second = y;
+  } else {
+    cycle_history.insert(it, {phase, y});
+  }
+}
+
+bool Integrator::continues_history(const State& state, double time) const {
+  return (num_history > 0) &&
+         (std::abs(time - history_time[0]) <= 1.0e-6 * time_step_size) &&
+         (state.y == history_y.col(0));
+}
+
+double Integrator::get_phase(double time) const {
+  double period = model->cardiac_cycle_period;
+  double phase = time - std::floor(time / period) * period;
+  if (phase >= period - 1.0e-6 * time_step_size) {
+    phase = 0.0;
+  }
+  return std::max(phase, 0.0);
 }
 
 double Integrator::avg_nonlin_iter() {
   return (double)n_nonlin_iter / (double)n_iter;
 }
+
+double Integrator::get_time_offset() const {
+  return alpha_f * time_step_size;
+}
+
+int Integrator::num_saved_factorizations() const {
+  return n_saved_factorizations;
+}
+
+int Integrator::num_events() const { return n_events; }
+
+int Integrator::num_nonlin_iter() const { return n_nonlin_iter; }
+
+int Integrator::num_backtracks() const { return n_backtracks; }
+
+int Integrator::num_rejected_steps() const { return n_rejected_steps; }
+
+double Integrator::get_error_constant() const {
+  return 1.0 / 12.0 - 0.5 * alpha_m + alpha_f * gamma;
+}
+
+void Integrator::filter_error(
+    const Eigen::Matrix<double, Eigen::Dynamic, 1>& error,
+    Eigen::Matrix<double, Eigen::Dynamic, 1>& filtered) {
+  if (factorized_time_step_size != time_step_size) {
+    system.update_jacobian(alpha_m, y_coeff_jacobian);
+    system.factorize();
+    factorized_time_step_size = time_step_size;
+  }
+
+  // The products are evaluated separately to avoid the sparse sum
+  error_rhs.noalias() = system.E * error;
+  error_rhs.noalias() += system.dC_dydot * error;
+  error_rhs *= alpha_m;
+  system.solver->solve(error_rhs, filtered);
+}
+
+const LinearSolver& Integrator::get_linear_solver() const {
+  return *system.solver;
+}
@@ -8,6 +8,10 @@
 #define SVZERODSOLVER_ALGEBRA_INTEGRATOR_HPP_
 
 #include <Eigen/Dense>
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "Model.h"
 #include "State.h"
@@ -25,6 +29,14 @@
 
 class Integrator {
  private:
+  /// Predictor of the non-linear iterations
+  enum class Predictor {
+    constant = 0,      ///< Constant solution
+    extrapolate2 = 1,  ///< Linear extrapolation of the last two time steps
+    extrapolate3 = 2,  ///< Quadratic extrapolation of the last three steps
+    periodic = 3,      ///< Solution at the same phase of the previous cycle
+  };
+
   double alpha_m{0.0};
   double alpha_f{0.0};
   double gamma{0.0};
@@ -34,14 +46,139 @@ class Integrator {
   double y_coeff_jacobian{0.0};
   double atol{0.0};
   int max_iter{0};
+  int jacobian_reuse_steps{0};
+  double jacobian_reuse_rate{0.0};
+  int jacobian_age{0};
+  bool jacobian_factorized{false};
+  double factorized_time_step_size{0.0};
+  bool linear_time_invariant{false};
   int size{0};
   int n_iter{0};
   int n_nonlin_iter{0};
+  int n_saved_factorizations{0};
+  bool event_detection{false};
+  bool line_search{false};
+  int max_step_halvings{0};
+  int n_events{0};
+  int n_backtracks{0};
+  int n_rejected_steps{0};
+  Predictor predictor{Predictor::constant};
+  int num_history{0};
+  std::array<double, 3> history_time{};
+  Eigen::Matrix<double, Eigen::Dynamic, 3> history_y;
+  double last_phase{0.0};
+  std::vector<std::pair<double, Eigen::Matrix<double, Eigen::Dynamic, 1>>>
+      cycle_history;
+  std::vector<double> switching_old;
+  std::vector<double> switching_new;
+  std::vector<double> switching_lower;
+  std::vector<double> switching_upper;
+  Eigen::Matrix<double, Eigen::Dynamic, 1> event_y;
+  State event_state;
+  State event_trial_state;
   Eigen::Matrix<double, Eigen::Dynamic, 1> y_af;
   Eigen::Matrix<double, Eigen::Dynamic, 1> ydot_am;
+  Eigen::Matrix<double, Eigen::Dynamic, 1> increment;
+  Eigen::Matrix<double, Eigen::Dynamic, 1> error_rhs;
   SparseSystem system;
   Model* model{nullptr};
 
+  /**
+   * @brief Perform a time step, repeated as two steps of half the size if the
+   * non-linear iterations fail (up to the maximum number of halvings)
+   *
+   * @param state Current state
+   * @param time Current time
+   * @param new_state New state
+   * @param num_halvings Number of halvings of the time step so far
+   */
+  void solve_step(const State& state, double time, State& new_state,
+                  int num_halvings = 0);
+
+  /**
+   * @brief Perform a time step with the non-linear iterations
+   *
+   * @param state Current state
+   * @param time Current time
+   * @param new_state New state
+   * @param use_predictor Start from the predicted solution (see step). If
+   * the non-linear iterations fail, they are repeated without it.
+   */
+  void newton_step(const State& state, double time, State& new_state,
+                   bool use_predictor = true);
+
+  /**
+   * @brief Update the iterate with the increment in `system.dydot`, halved
+   * until the 2-norm of the residual decreases sufficiently
+   *
+   * Leaves the residual of the new iterate in `system.residual`.
+   *
+   * @param old_state State at the start of the time step
+   * @param new_state Current iterate (updated)
+   */
+  void update_with_line_search(const State& old_state, State& new_state);
+
+  /**
+   * @brief Check if a switching function changed its sign in a step
+   *
+   * Evaluates the switching functions of the new state in `switching_new`
+   * and compares them against `switching_old`.
+   *
+   * @param state New state
+   * @return bool True if an event occurred
+   */
+  bool has_event(const State& state);
+
+  /**
+   * @brief Predict the solution at the end of a time step
+   *
+   * @param state Current state
+   * @param time Current time
+   * @param y Predicted solution (only set if the function returns true)
+   * @return bool False if the constant predictor is used (no history of
+   * the current state)
+   */
+  bool predict(const State& state, double time,
+               Eigen::Matrix<double, Eigen::Dynamic, 1>& y);
+
+  /**
+   * @brief Add the result of a time step to the history of the predictor
+   *
+   * @param old_state State at the start of the time step
+   * @param time Time at the start of the time step
+   * @param new_state State at the end of the time step
+   * @param new_time Time at the end of the time step
+   */
+  void update_history(const State& old_state, double time,
+                      const State& new_state, double new_time);
+
+  /**
+   * @brief Add a solution to the history of the cardiac cycle (sorted by the
+   * phase), replacing the solutions of the previous cycle up to its phase
+   *
+   * @param y Solution
+   * @param time Time
+   */
+  void update_cycle_history(const Eigen::Matrix<double, Eigen::Dynamic, 1>& y,
+                            double time);
+
+  /**
+   * @brief Check if a state continues the history of the predictor
+   *
+   * @param state State
+   * @param time Time
+   * @return bool True if the state is the last one in the history
+   */
+  bool continues_history(const State& state, double time) const;
+
+  /**
+   * @brief Get the phase of a time within the cardiac cycle
+   *
+   * @param time Time
+   * @return double Phase in [0, cardiac_cycle_period)
+   */
+  double get_phase(double time) const;
+
  public:
   /**
    * @brief Construct a new Integrator object
@@ -51,9 +188,30 @@ class Integrator {
    * @param rho Spectral radius for generalized-alpha step
    * @param atol Absolut tolerance for non-linear iteration termination
    * @param max_iter Maximum number of non-linear iterations
+   * @param linear_solver Name of the linear solver (see create_linear_solver)
+   * @param ordering Name of the fill-reducing column ordering of the linear
+   * solver
+   * @param jacobian_reuse_steps Maximum number of time steps in which a
+   * factorization of the Jacobian is reused (0: factorize in every non-linear
+   * iteration)
+   * @param jacobian_reuse_rate Maximum ratio of the residual norms of two
+   * consecutive non-linear iterations with a reused factorization
+   * @param event_detection Split the time steps at the switches of discrete
+   * states of the blocks (see step)
+   * @param line_search Damp the non-linear increments with a backtracking
+   * line search (see step)
+   * @param max_step_halvings Maximum number of times a time step is halved
+   * if the non-linear iterations fail (see step)
+   * @param predictor Name of the predictor of the non-linear iterations
+   * (`constant`, `extrapolate2`, `extrapolate3`, `periodic`, see step)
    */
   Integrator(Model* model, double time_step_size, double rho, double atol,
-             int max_iter);
+             int max_iter, const std::string& linear_solver = "sparse_lu",
+             const std::string& ordering = "colamd",
+             int jacobian_reuse_steps = 0, double jacobian_reuse_rate = 0.5,
+             bool event_detection = false, bool line_search = false,
+             int max_step_halvings = 0,
+             const std::string& predictor = "constant");
 
   /**
    * @brief Construct a new Integrator object
@@ -81,15 +239,100 @@ class Integrator {
    */
   void update_params(double time_step_size);
 
+  /**
+   * @brief Reset the integrator for a new simulation of the same model
+   *
+   * Discards the factorization of the Jacobian, the history of the predictor,
+   * the discrete states of the event detection and the counters (including
+   * the statistics of the linear solver), but keeps the
+   * system with the analyzed sparsity pattern of the linear solver. Together
+   * with update_params (called before), the integrator then behaves like a
+   * new one.
+   */
+  void reset();
+
+  /**
+   * @brief Change the time step size of the following steps
+   *
+   * Unlike update_params, this does not re-evaluate the model. It only
+   * discards the factorization of the Jacobian, which depends on the time
+   * step size.
+   *
+   * @param time_step_size Time step size
+   */
+  void set_time_step_size(double time_step_size);
+
+  /**
+   * @brief Get the time step size
+   *
+   * @return double Time step size
+   */
+  double get_time_step_size() const;
+
   /**
    * @brief Perform a time step
    *
+   * If Jacobian reuse is enabled (modified Newton method), the factorization
+   * of the Jacobian is kept across non-linear iterations and time steps. It is
+   * only recomputed if the residual norm decreases by less than the reuse
+   * rate in one iteration, if the observed rate doesn't reach the tolerance
+   * within the remaining non-linear iterations, or if it is older than the
+   * maximum number of reuse steps. Models whose blocks modify the iterates in
+   * post_solve (see Model::modifies_solution) don't support Jacobian reuse.
+   *
+   * For linear time-invariant models (see Model::is_linear_time_invariant),
+   * the Jacobian is constant. It is only factorized once and each time step
+   * is a single solve without non-linear iterations.
+   *
+   * The non-linear iterations start from a predicted solution with a
+   * consistent time derivative. By default, the solution is constant. It can
+   * instead be extrapolated from the last two (linear) or three (quadratic)
+   * time steps, or taken from the same phase of the previous cardiac cycle
+   * (periodic, interpolated between the time steps of that cycle). Until
+   * enough time steps are available, the periodic predictor falls back to the
+   * linear and the quadratic to the linear or constant predictor. A
+   * predicted solution is corrected at least once, and the non-linear
+   * iterations are repeated from the constant solution if they fail. The
+   * predictor only changes the number of non-linear iterations, not the
+   * converged solution. Models whose blocks modify the iterates in
+   * post_solve (see Model::modifies_solution) only support the constant
+   * predictor.
+   *
+   * With the line search, the increment of a non-linear iteration is halved
+   * (at most four times) until the 2-norm of the residual decreases
+   * sufficiently (Armijo condition). If the non-linear iterations fail to
+   * converge, the step can be repeated as two steps of half the time step
+   * size (recursively up to the maximum number of halvings).
+   *
+   * With event detection, the discrete states of the blocks (e.g. valve
+   * positions, see Block::get_switching_functions) are set at the start of
+   * the step and kept during the non-linear iterations. If a switching
+   * function changes its sign within the step, the time of the first sign
+   * change is located with the regula falsi method (repeating the step with
+   * shorter time step sizes) to a fraction of the time step size. The step
+   * is split there and continued with the switched discrete states.
+   *
    * @param state Current state
    * @param time Current time
    * @return New state
    */
   State step(const State& state, double time);
 
+  /**
+   * @brief Perform a time step in place (see step)
+   *
+   * The new state is written into a preallocated state (of the size of the
+   * model), which must not be the current state. Together with the work
+   * vectors of the integrator, a time step does not allocate memory (apart
+   * from the factorizations of the linear solver and the repetition of
+   * rejected steps).
+   *
+   * @param state Current state
+   * @param new_state New state
+   * @param time Current time
+   */
+  void step(const State& state, State& new_state, double time);
+
   /**
    * @brief Get average number of nonlinear iterations in all step calls
    *
@@ -97,6 +340,98 @@ class Integrator {
    *
    */
   double avg_nonlin_iter();
+
+  /**
+   * @brief Get number of non-linear iterations that reused a factorization
+   * of the Jacobian
+   *
+   * @return Number of saved factorizations in all step calls
+   */
+  int num_saved_factorizations() const;
+
+  /**
+   * @brief Get the number of events at which time steps were split
+   *
+   * @return int Number of events in all step calls
+   */
+  int num_events() const;
+
+  /**
+   * @brief Get the number of non-linear iterations
+   *
+   * @return int Number of non-linear iterations in all step calls
+   */
+  int num_nonlin_iter() const;
+
+  /**
+   * @brief Get the number of halvings of the increment in the line search
+   *
+   * @return int Number of backtracking steps in all step calls
+   */
+  int num_backtracks() const;
+
+  /**
+   * @brief Get the number of time steps that were rejected and repeated with
+   * half the time step size
+   *
+   * @return int Number of rejected time steps in all step calls
+   */
+  int num_rejected_steps() const;
+
+  /**
+   * @brief Get the offset of the time at which the model is evaluated within
+   * a time step (generalized mid-point)
+   *
+   * @return Time offset
+   */
+  double get_time_offset() const;
+
+  /**
+   * @brief Get the leading coefficient of the local truncation error
+   *
+   * The error of a time step is \f$y_{n+1} - y(t_{n+1}) \approx C \Delta t^3
+   * \dddot{y}\f$ with
+   *
+   * \f[
+   * C = \frac{1}{12} - \frac{\alpha_m}{2} + \alpha_f \gamma,
+   * \f]
+   *
+   * the third-order term of the principal root of the amplification matrix
+   * for \f$\dot{y} = \lambda y\f$ (\f$C = 1/12\f$ for
+   * \f$\rho_{\infty} = 1\f$, the trapezoidal rule, and \f$C = 1/9\f$ for
+   * \f$\rho_{\infty} = 0.5\f$).
+   *
+   * @return double Error coefficient
+   */
+  double get_error_constant() const;
+
+  /**
+   * @brief Filter an estimate of the local truncation error of the last step
+   *
+   * Solves \f$\mathbf{J} \tilde{e} = \alpha_m (\mathbf{E} + \partial
+   * \mathbf{C} / \partial \dot{y}) e\f$ with the Jacobian \f$\mathbf{J}\f$
+   * of the step (factorized again if the time step size changed since its
+   * last factorization). The filtered error only depends on the differential
+   * degrees-of-freedom of the estimate and satisfies the linearized algebraic
+   * equations, which gives the error of the algebraic degrees-of-freedom.
+   * Stiff components of the estimate are damped, as with the filter of
+   * Shampine for implicit methods.
+   *
+   * Uses a work vector of the integrator and doesn't allocate memory (apart
+   * from the factorization of the linear solver).
+   *
+   * @param error Estimate of the error of \f$y\f$
+   * @param filtered Filtered error (must not be the estimate)
+   */
+  void filter_error(const Eigen::Matrix<double, Eigen::Dynamic, 1>& error,
+                    Eigen::Matrix<double, Eigen::Dynamic, 1>& filtered);
+
+  /**
+   * @brief Get the linear solver of the system
+   *
+   * @return const LinearSolver& Linear solver
+   */
+  const LinearSolver& get_linear_solver() const;
 };
 
 #endif  // SVZERODSOLVER_ALGEBRA_INTEGRATOR_HPP_
@@ -0,0 +1,387 @@
+// SPDX-FileCopyrightText: Copyright (c) Stanford University, The Regents of the
+// University of California, and others. SPDX-License-Identifier: BSD-3-Clause
+
+#include "LinearSolver.h"
+
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+LinearSolver::~LinearSolver() {}
+
+void LinearSolver::analyze_pattern(const Eigen::SparseMatrix<double>& matrix) {
+  analyze_pattern_impl(matrix);
+}
+
+void LinearSolver::factorize(const Eigen::SparseMatrix<double>& matrix) {
+  auto start = std::chrono::steady_clock::now();
+  bool success = factorize_impl(matrix);
+  auto end = std::chrono::steady_clock::now();
+  statistics.factorization_time +=
+      std::chrono::duration<double>(end - start).count();
+  statistics.num_factorizations++;
+  if (!success) {
+    throw std::runtime_error(
+        "System is singular. Check your model (connections, boundary "
+        "conditions, parameters).");
+  }
+}
+
+void LinearSolver::solve(const Eigen::Matrix<double, Eigen::Dynamic, 1>& rhs,
+                         Eigen::Matrix<double, Eigen::Dynamic, 1>& x) {
+  auto start = std::chrono::steady_clock::now();
+  solve_impl(rhs, x);
+  auto end = std::chrono::steady_clock::now();
+  statistics.solve_time += std::chrono::duration<double>(end - start).count();
+  statistics.num_solves++;
+}
+
+const LinearSolverStatistics& LinearSolver::get_statistics() const {
+  return statistics;
+}
+
+void LinearSolver::reset_statistics() { statistics = LinearSolverStatistics(); }
+
+std::string DenseLUSolver::get_name() const { return "dense_lu"; }
+
+void DenseLUSolver::analyze_pattern_impl(
+    const Eigen::SparseMatrix<double>& matrix) {
+  dense.resize(matrix.rows(), matrix.cols());
+}
+
+bool DenseLUSolver::factorize_impl(const Eigen::SparseMatrix<double>& matrix) {
+  dense = matrix;
+  solver.compute(dense);
+
+  // PartialPivLU does not detect singular matrices
+  return solver.matrixLU().diagonal().cwiseAbs().minCoeff() > 0.0;
+}
+
+void DenseLUSolver::solve_impl(
+    const Eigen::Matrix<double, Eigen::Dynamic, 1>& rhs,
+    Eigen::Matrix<double, Eigen::Dynamic, 1>& x) {
+  x = solver.solve(rhs);
+}
+
+template <typename Ordering>
+void KLUSolver<Ordering>::analyze_pattern_impl(
+    const Eigen::SparseMatrix<double>& matrix) {
+  if (!matrix.isCompressed()) {
+    throw std::runtime_error("KLU solver requires a compressed matrix.");
+  }
+  n = matrix.cols();
+
+  // Fill-reducing column ordering (maps old to new column indices)
+  Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic, int> perm;
+  Ordering ordering;
+  ordering(matrix, perm);
+  if (perm.size() == 0) {
+    perm.setIdentity(n);  // Natural ordering
+  }
+  q.resize(n);
+  q_inv.resize(n);
+  for (int j = 0; j < n; j++) {
+    q_inv[j] = perm.indices()(j);
+    q[q_inv[j]] = j;
+  }
+
+  pinv.assign(n, -1);
+  x.assign(n, 0.0);
+  xi.resize(n);
+  stack.resize(n);
+  pstack.resize(n);
+  marked.assign(n, 0);
+  factorized = false;
+}
+
+template <typename Ordering>
+bool KLUSolver<Ordering>::factorize_impl(
+    const Eigen::SparseMatrix<double>& matrix) {
+  if (factorized && (matrix.nonZeros() == (int)matrix_values.size())) {
+    // Find the first column of the permuted matrix that changed
+    const double* values = matrix.valuePtr();
+    const int* outer = matrix.outerIndexPtr();
+    int start = n;
+    for (int j = 0; j < n; j++) {
+      for (int p = outer[j]; p < outer[j + 1]; p++) {
+        if (values[p] != matrix_values[p]) {
+          start = std::min(start, q_inv[j]);
+          break;
+        }
+      }
+    }
+    if (refactorize(matrix, start)) {
+      return true;
+    }
+  }
+
+  // Factorization with pivoting if no pivots are available or if a pivot
+  // became too small
+  statistics.num_full_factorizations++;
+  factorized = factorize_full(matrix);
+  return factorized;
+}
+
+template <typename Ordering>
+void KLUSolver<Ordering>::solve_impl(
+    const Eigen::Matrix<double, Eigen::Dynamic, 1>& rhs,
+    Eigen::Matrix<double, Eigen::Dynamic, 1>& sol) {
+  // Permute right-hand side (rows in pivot order)
+  for (int i = 0; i < n; i++) {
+    x[pinv[i]] = rhs[i];
+  }
+
+  // Forward substitution with unit lower triangular L (diagonal first)
+  for (int j = 0; j < n; j++) {
+    for (int p = Lp[j] + 1; p < Lp[j + 1]; p++) {
+      x[Li[p]] -= Lx[p] * x[j];
+    }
+  }
+
+  // Backward substitution with upper triangular U (diagonal last)
+  for (int j = n - 1; j >= 0; j--) {
+    x[j] /= Ux[Up[j + 1] - 1];
+    for (int p = Up[j]; p < Up[j + 1] - 1; p++) {
+      x[Ui[p]] -= Ux[p] * x[j];
+    }
+  }
+
+  // Permute solution back to original columns
+  sol.resize(n);
+  for (int k = 0; k < n; k++) {
+    sol[q[k]] = x[k];
+  }
+}
+
+template <typename Ordering>
+int KLUSolver<Ordering>::reach(const Eigen::SparseMatrix<double>& matrix,
+                               int col) {
+  // Depth-first search in the graph of L from all non-zeros of the column of
+  // the matrix. Returns the non-zero pattern of the solution of L x = A(:,col)
+  // in topological order in xi[top], ..., xi[n-1].
+  int top = n;
+  for (int p = matrix.outerIndexPtr()[col];
+       p < matrix.outerIndexPtr()[col + 1]; p++) {
+    int root = matrix.innerIndexPtr()[p];
+    if (marked[root]) {
+      continue;
+    }
+    int head = 0;
+    stack[0] = root;
+    while (head >= 0) {
+      int j = stack[head];
+      int jnew = pinv[j];
+      if (!marked[j]) {
+        marked[j] = 1;
+        pstack[head] = (jnew < 0) ? 0 : Lp[jnew];
+      }
+      bool done = true;
+      int pend = (jnew < 0) ? 0 : Lp[jnew + 1];
+      for (int pp = pstack[head]; pp < pend; pp++) {
+        int i = Li[pp];
+        if (marked[i]) {
+          continue;
+        }
+        pstack[head] = pp;
+        stack[++head] = i;
+        done = false;
+        break;
+      }
+      if (done) {
+        head--;
+        xi[--top] = j;
+      }
+    }
+  }
+  for (int p = top; p < n; p++) {
+    marked[xi[p]] = 0;
+  }
+  return top;
+}
+
+template <typename Ordering>
+bool KLUSolver<Ordering>::factorize_full(
+    const Eigen::SparseMatrix<double>& matrix) {
+  // Left-looking LU decomposition (Gilbert-Peierls) with threshold partial
+  // pivoting. During the factorization, the row indices of L refer to the
+  // original rows and are mapped to pivot order at the end.
+  Lp.assign(n + 1, 0);
+  Up.assign(n + 1, 0);
+  Li.clear();
+  Lx.clear();
+  Ui.clear();
+  Ux.clear();
+  pinv.assign(n, -1);
+
+  for (int k = 0; k < n; k++) {
+    Lp[k] = Li.size();
+    Up[k] = Ui.size();
+    int col = q[k];
+
+    // Sparse triangular solve x = L \ A(:,col)
+    int top = reach(matrix, col);
+    for (int p = top; p < n; p++) {
+      x[xi[p]] = 0.0;
+    }
+    for (int p = matrix.outerIndexPtr()[col];
+         p < matrix.outerIndexPtr()[col + 1]; p++) {
+      x[matrix.innerIndexPtr()[p]] = matrix.valuePtr()[p];
+    }
+    for (int px = top; px < n; px++) {
+      int j = xi[px];
+      int jnew = pinv[j];
+      if (jnew < 0) {
+        continue;
+      }
+      for (int p = Lp[jnew] + 1; p < Lp[jnew + 1]; p++) {
+        x[Li[p]] -= Lx[p] * x[j];
+      }
+    }
+
+    // Pick the largest candidate as pivot and store column of U
+    int ipiv = -1;
+    bool diag_in_pattern = false;
+    double a = -1.0;
+    for (int px = top; px < n; px++) {
+      int i = xi[px];
+      if (pinv[i] < 0) {
+        diag_in_pattern |= (i == col);
+        if (std::abs(x[i]) > a) {
+          a = std::abs(x[i]);
+          ipiv = i;
+        }
+      } else {
+        Ui.push_back(pinv[i]);
+        Ux.push_back(x[i]);
+      }
+    }
+    if ((ipiv == -1) || (a <= 0.0)) {
+      return false;
+    }
+
+    // Prefer the diagonal if it is large enough
+    if (diag_in_pattern && (std::abs(x[col]) >= a * pivot_tol)) {
+      ipiv = col;
+    }
+    double pivot = x[ipiv];
+    Ui.push_back(k);
+    Ux.push_back(pivot);
+    pinv[ipiv] = k;
+
+    // Store column of L (unit diagonal first)
+    Li.push_back(ipiv);
+    Lx.push_back(1.0);
+    for (int px = top; px < n; px++) {
+      int i = xi[px];
+      if (pinv[i] < 0) {
+        Li.push_back(i);
+        Lx.push_back(x[i] / pivot);
+      }
+    }
+  }
+  Lp[n] = Li.size();
+  Up[n] = Ui.size();
+
+  // Map row indices of L to pivot order
+  for (auto& i : Li) {
+    i = pinv[i];
+  }
+
+  matrix_values.assign(matrix.valuePtr(),
+                       matrix.valuePtr() + matrix.nonZeros());
+  return true;
+}
+
+template <typename Ordering>
+bool KLUSolver<Ordering>::refactorize(const Eigen::SparseMatrix<double>& matrix,
+                                      int start) {
+  // Recompute the values of columns start, ..., n-1 of the factors with the
+  // pivot sequence and the factor patterns of the last full factorization
+  for (int k = start; k < n; k++) {
+    int col = q[k];
+    for (int p = Up[k]; p < Up[k + 1]; p++) {
+      x[Ui[p]] = 0.0;
+    }
+    for (int p = Lp[k]; p < Lp[k + 1]; p++) {
+      x[Li[p]] = 0.0;
+    }
+    for (int p = matrix.outerIndexPtr()[col];
+         p < matrix.outerIndexPtr()[col + 1]; p++) {
+      x[pinv[matrix.innerIndexPtr()[p]]] = matrix.valuePtr()[p];
+    }
+
+    // Entries of U are stored in topological order (diagonal last)
+    for (int p = Up[k]; p < Up[k + 1] - 1; p++) {
+      int j = Ui[p];
+      Ux[p] = x[j];
+      for (int pp = Lp[j] + 1; pp < Lp[j + 1]; pp++) {
+        x[Li[pp]] -= Lx[pp] * x[j];
+      }
+    }
+
+    // Check that the pivot still satisfies the pivoting threshold
+    double pivot = x[k];
+    double a = std::abs(pivot);
+    for (int p = Lp[k] + 1; p < Lp[k + 1]; p++) {
+      a = std::max(a, std::abs(x[Li[p]]));
+    }
+    if ((pivot == 0.0) || (std::abs(pivot) < a * pivot_tol)) {
+      return false;
+    }
+    Ux[Up[k + 1] - 1] = pivot;
+    for (int p = Lp[k] + 1; p < Lp[k + 1]; p++) {
+      Lx[p] = x[Li[p]] / pivot;
+    }
+  }
+
+  std::copy(matrix.valuePtr(), matrix.valuePtr() + matrix.nonZeros(),
+            matrix_values.begin());
+  return true;
+}
+
+template class KLUSolver<Eigen::COLAMDOrdering<int>>;
+template class KLUSolver<Eigen::AMDOrdering<int>>;
+template class KLUSolver<Eigen::NaturalOrdering<int>>;
+
+/**
+ * @brief Create a linear solver with a given fill-reducing column ordering
+ *
+ * @tparam Ordering Fill-reducing column ordering
+ * @param linear_solver Name of the linear solver
+ * @param name Name of the linear solver including the ordering
+ * @return std::shared_ptr<LinearSolver> The linear solver
+ */
+template <typename Ordering>
+static std::shared_ptr<LinearSolver> create_ordered_linear_solver(
+    const std::string& linear_solver, const std::string& name) {
+  if (linear_solver == "sparse_lu") {
+    return std::shared_ptr<LinearSolver>(new SparseLUSolver<Ordering>(name));
+  } else if (linear_solver == "sparse_qr") {
+    return std::shared_ptr<LinearSolver>(new SparseQRSolver<Ordering>(name));
+  } else if (linear_solver == "klu") {
+    return std::shared_ptr<LinearSolver>(new KLUSolver<Ordering>(name));
+  }
+  throw std::runtime_error(
+      "Invalid linear solver " + linear_solver +
+      ". Options are sparse_lu, sparse_qr, dense_lu, klu.");
+}
+
+std::shared_ptr<LinearSolver> create_linear_solver(
+    const std::string& linear_solver, const std::string& ordering) {
+  if (linear_solver == "dense_lu") {
+    return std::shared_ptr<LinearSolver>(new DenseLUSolver());
+  }
+  std::string name = linear_solver + " (" + ordering + ")";
+  if (ordering == "colamd") {
+    return create_ordered_linear_solver<Eigen::COLAMDOrdering<int>>(
+        linear_solver, name);
+  } else if (ordering == "amd") {
+    return create_ordered_linear_solver<Eigen::AMDOrdering<int>>(linear_solver,
+                                                                 name);
+  } else if (ordering == "natural") {
+    return create_ordered_linear_solver<Eigen::NaturalOrdering<int>>(
+        linear_solver, name);
+  }
+  throw std::runtime_error("Invalid linear solver ordering " + ordering +
+                           ". Options are colamd, amd, natural.");
+}
@@ -0,0 +1,313 @@
+// SPDX-FileCopyrightText: Copyright (c) Stanford University, The Regents of the
+// University of California, and others. SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file LinearSolver.h
+ * @brief LinearSolver source file
+ */
+#ifndef SVZERODSOLVER_ALGEBRA_LINEARSOLVER_HPP_
+#define SVZERODSOLVER_ALGEBRA_LINEARSOLVER_HPP_
+
+#include <Eigen/Dense>
+#include <Eigen/OrderingMethods>
+#include <Eigen/Sparse>
+#include <Eigen/SparseLU>
+#include <Eigen/SparseQR>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Statistics of a linear solver
+ */
+struct LinearSolverStatistics {
+  int num_factorizations{0};        ///< Number of numerical factorizations
+  int num_solves{0};                ///< Number of solves
+  double factorization_time{0.0};   ///< Total factorization time in seconds
+  double solve_time{0.0};           ///< Total solve time in seconds
+  int num_full_factorizations{0};   ///< Number of factorizations with pivoting
+                                    ///< (only for backends with
+                                    ///< refactorization)
+};
+
+/**
+ * @brief Linear solver for the sparse systems of the time integration
+ *
+ * A linear solver analyzes the sparsity pattern of the system matrix once
+ * and then repeatedly factorizes matrices with the same pattern and solves for
+ * right-hand sides. The factorization and solve times of all calls are
+ * collected in the solver statistics.
+ *
+ * The available backends are selected with the `linear_solver` key in the
+ * simulation parameters (see create_linear_solver).
+ */
+class LinearSolver {
+ public:
+  /**
+   * @brief Destroy the Linear Solver object
+   *
+   */
+  virtual ~LinearSolver();
+
+  /**
+   * @brief Analyze the sparsity pattern of the system matrix
+   *
+   * @param matrix System matrix
+   */
+  void analyze_pattern(const Eigen::SparseMatrix<double>& matrix);
+
+  /**
+   * @brief Factorize the system matrix
+   *
+   * Throws an error if the matrix is singular.
+   *
+   * @param matrix System matrix with the analyzed sparsity pattern
+   */
+  void factorize(const Eigen::SparseMatrix<double>& matrix);
+
+  /**
+   * @brief Solve the factorized system
+   *
+   * @param rhs Right-hand side
+   * @param x Solution
+   */
+  void solve(const Eigen::Matrix<double, Eigen::Dynamic, 1>& rhs,
+             Eigen::Matrix<double, Eigen::Dynamic, 1>& x);
+
+  /**
+   * @brief Get the name of the linear solver
+   *
+   * @return std::string Name of the linear solver
+   */
+  virtual std::string get_name() const = 0;
+
+  /**
+   * @brief Get the statistics of the linear solver
+   *
+   * @return const LinearSolverStatistics& Statistics
+   */
+  const LinearSolverStatistics& get_statistics() const;
+
+  /// Reset the statistics of the linear solver
+  void reset_statistics();
+
+ protected:
+  LinearSolverStatistics statistics;  ///< Statistics of the linear solver
+
+  /**
+   * @brief Analyze the sparsity pattern of the system matrix
+   *
+   * @param matrix System matrix
+   */
+  virtual void analyze_pattern_impl(
+      const Eigen::SparseMatrix<double>& matrix) = 0;
+
+  /**
+   * @brief Factorize the system matrix
+   *
+   * @param matrix System matrix
+   * @return bool True if the factorization was successful
+   */
+  virtual bool factorize_impl(const Eigen::SparseMatrix<double>& matrix) = 0;
+
+  /**
+   * @brief Solve the factorized system
+   *
+   * @param rhs Right-hand side
+   * @param x Solution
+   */
+  virtual void solve_impl(const Eigen::Matrix<double, Eigen::Dynamic, 1>& rhs,
+                          Eigen::Matrix<double, Eigen::Dynamic, 1>& x) = 0;
+};
+
+/**
+ * @brief Sparse LU decomposition (Eigen::SparseLU)
+ *
+ * @tparam Ordering Fill-reducing column ordering
+ */
+template <typename Ordering>
+class SparseLUSolver : public LinearSolver {
+ public:
+  /**
+   * @brief Construct a new Sparse LU Solver object
+   *
+   * @param name Name of the solver (including the ordering)
+   */
+  SparseLUSolver(const std::string& name) : name(name) {}
+
+  std::string get_name() const override { return name; }
+
+ protected:
+  void analyze_pattern_impl(
+      const Eigen::SparseMatrix<double>& matrix) override {
+    solver.analyzePattern(matrix);
+  }
+
+  bool factorize_impl(const Eigen::SparseMatrix<double>& matrix) override {
+    solver.factorize(matrix);
+    return solver.info() == Eigen::Success;
+  }
+
+  void solve_impl(const Eigen::Matrix<double, Eigen::Dynamic, 1>& rhs,
+                  Eigen::Matrix<double, Eigen::Dynamic, 1>& x) override {
+    x = solver.solve(rhs);
+  }
+
+ private:
+  std::string name;
+  Eigen::SparseLU<Eigen::SparseMatrix<double>, Ordering> solver;
+};
+
+/**
+ * @brief Sparse QR decomposition (Eigen::SparseQR)
+ *
+ * Slower than a sparse LU decomposition but more robust for nearly singular
+ * systems. The columns are scaled to unit norm before the decomposition, such
+ * that the default pivot threshold of Eigen (relative to the largest column
+ * norm) detects the numerical rank also for badly scaled unknowns (e.g. flow
+ * and pressure). The columns below the threshold are dropped, which gives a
+ * basic (not the minimum-norm) least-squares solution of rank-deficient
+ * systems.
+ *
+ * @tparam Ordering Fill-reducing column ordering
+ */
+template <typename Ordering>
+class SparseQRSolver : public LinearSolver {
+ public:
+  /**
+   * @brief Construct a new Sparse QR Solver object
+   *
+   * @param name Name of the solver (including the ordering)
+   */
+  SparseQRSolver(const std::string& name) : name(name) {}
+
+  std::string get_name() const override { return name; }
+
+ protected:
+  void analyze_pattern_impl(
+      const Eigen::SparseMatrix<double>& matrix) override {
+    solver.analyzePattern(matrix);
+  }
+
+  bool factorize_impl(const Eigen::SparseMatrix<double>& matrix) override {
+    // Scaling keeps the sparsity pattern of the analyzed matrix (empty
+    // columns are not scaled)
+    column_scale.resize(matrix.cols());
+    for (int j = 0; j < matrix.cols(); j++) {
+      double norm = matrix.col(j).norm();
+      column_scale[j] = (norm > 0.0) ? 1.0 / norm : 1.0;
+    }
+    scaled_matrix = matrix * column_scale.asDiagonal();
+    solver.factorize(scaled_matrix);
+    return solver.info() == Eigen::Success;
+  }
+
+  void solve_impl(const Eigen::Matrix<double, Eigen::Dynamic, 1>& rhs,
+                  Eigen::Matrix<double, Eigen::Dynamic, 1>& x) override {
+    x = column_scale.cwiseProduct(solver.solve(rhs));
+  }
+
+ private:
+  std::string name;
+  Eigen::SparseQR<Eigen::SparseMatrix<double>, Ordering> solver;
+  Eigen::Matrix<double, Eigen::Dynamic, 1>
+      column_scale;  ///< Inverse norms of the columns
+  Eigen::SparseMatrix<double> scaled_matrix;  ///< Matrix with scaled columns
+};
+
+/**
+ * @brief Dense LU decomposition with partial pivoting (Eigen::PartialPivLU)
+ *
+ * Avoids the overhead of sparse data structures for small systems, e.g.
+ * closed-loop heart models with few degrees-of-freedom.
+ */
+class DenseLUSolver : public LinearSolver {
+ public:
+  std::string get_name() const override;
+
+ protected:
+  void analyze_pattern_impl(
+      const Eigen::SparseMatrix<double>& matrix) override;
+
+  bool factorize_impl(const Eigen::SparseMatrix<double>& matrix) override;
+
+  void solve_impl(const Eigen::Matrix<double, Eigen::Dynamic, 1>& rhs,
+                  Eigen::Matrix<double, Eigen::Dynamic, 1>& x) override;
+
+ private:
+  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> dense;
+  Eigen::PartialPivLU<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>>
+      solver;
+};
+
+/**
+ * @brief Left-looking sparse LU decomposition with refactorization (KLU-style)
+ *
+ * The first factorization is a left-looking Gilbert-Peierls LU decomposition
+ * with threshold partial pivoting on a fill-reducing column ordering. Since
+ * the sparsity pattern of the system never changes, all following
+ * factorizations reuse the pivot sequence and the sparsity pattern of the
+ * factors and only recompute their values. Only the columns of the factors
+ * from the first column of the (permuted) matrix that changed are recomputed
+ * (partial refactorization), since the preceding columns of a left-looking
+ * decomposition only depend on preceding columns of the matrix. If a pivot
+ * becomes too small during a refactorization, a full factorization with
+ * pivoting is performed instead.
+ *
+ * @tparam Ordering Fill-reducing column ordering
+ */
+template <typename Ordering>
+class KLUSolver : public LinearSolver {
+ public:
+  /**
+   * @brief Construct a new KLU Solver object
+   *
+   * @param name Name of the solver (including the ordering)
+   */
+  KLUSolver(const std::string& name) : name(name) {}
+
+  std::string get_name() const override { return name; }
+
+ protected:
+  void analyze_pattern_impl(const Eigen::SparseMatrix<double>& matrix) override;
+
+  bool factorize_impl(const Eigen::SparseMatrix<double>& matrix) override;
+
+  void solve_impl(const Eigen::Matrix<double, Eigen::Dynamic, 1>& rhs,
+                  Eigen::Matrix<double, Eigen::Dynamic, 1>& x) override;
+
+ private:
+  std::string name;
+  int n{0};
+  bool factorized{false};       ///< Are pivots and factor patterns available?
+  double pivot_tol{1.0e-3};     ///< Relative threshold for partial pivoting
+  std::vector<int> q;           ///< Column permutation (new to old)
+  std::vector<int> q_inv;       ///< Inverse column permutation
+  std::vector<int> pinv;        ///< Inverse row permutation (old to new)
+  std::vector<int> Lp, Li, Up, Ui;  ///< Patterns of the factors (CSC)
+  std::vector<double> Lx, Ux;       ///< Values of the factors
+  std::vector<double> matrix_values;  ///< Values of the last factorized matrix
+  std::vector<double> x;              ///< Dense work vector
+  std::vector<int> xi, stack, pstack;  ///< Work vectors for depth-first search
+  std::vector<char> marked;            ///< Marker of visited nodes
+
+  bool factorize_full(const Eigen::SparseMatrix<double>& matrix);
+  bool refactorize(const Eigen::SparseMatrix<double>& matrix, int start);
+  int reach(const Eigen::SparseMatrix<double>& matrix, int col);
+};
+
+/**
+ * @brief Create a linear solver
+ *
+ * Available linear solvers are `sparse_lu` (default), `sparse_qr`,
+ * `dense_lu`, and `klu`. Available column orderings for the sparse solvers are
+ * `colamd` (default), `amd`, and `natural`.
+ *
+ * @param linear_solver Name of the linear solver
+ * @param ordering Name of the fill-reducing column ordering
+ * @return std::shared_ptr<LinearSolver> The linear solver
+ */
+std::shared_ptr<LinearSolver> create_linear_solver(
+    const std::string& linear_solver = "sparse_lu",
+    const std::string& ordering = "colamd");
+
+#endif  // SVZERODSOLVER_ALGEBRA_LINEARSOLVER_HPP_
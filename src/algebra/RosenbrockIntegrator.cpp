@@ -0,0 +1,178 @@
+// SPDX-FileCopyrightText: Copyright (c) Stanford University, The Regents of the
+// University of California, and others. SPDX-License-Identifier: BSD-3-Clause
+
+#include "RosenbrockIntegrator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+// Diagonal coefficient of ROS2 (L-stable)
+static const double gamma_ros2 = 1.0 + 1.0 / std::sqrt(2.0);
+
+RosenbrockIntegrator::RosenbrockIntegrator(Model* model,
+                                           double time_step_size,
+                                           double tolerance,
+                                           double min_time_step_size,
+                                           const std::string& linear_solver,
+                                           const std::string& ordering)
+    : model(model),
+      time_step_size(time_step_size),
+      tolerance(tolerance),
+      min_time_step_size(min_time_step_size),
+      substep_size(time_step_size) {
+  size = model->dofhandler.size();
+  system = SparseSystem(size);
+  system.solver = create_linear_solver(linear_solver, ordering);
+  system.reserve(model);
+  k1 = Eigen::Matrix<double, Eigen::Dynamic, 1>::Zero(size);
+  k2 = Eigen::Matrix<double, Eigen::Dynamic, 1>::Zero(size);
+  mass_k1 = Eigen::Matrix<double, Eigen::Dynamic, 1>::Zero(size);
+  y_stage = Eigen::Matrix<double, Eigen::Dynamic, 1>::Zero(size);
+  ydot_stage = Eigen::Matrix<double, Eigen::Dynamic, 1>::Zero(size);
+  f_time = Eigen::Matrix<double, Eigen::Dynamic, 1>::Zero(size);
+  y_scale = Eigen::Matrix<double, Eigen::Dynamic, 1>::Zero(size);
+}
+
+// Must declare default constructor and destructor because of Eigen.
+RosenbrockIntegrator::RosenbrockIntegrator() {}
+RosenbrockIntegrator::~RosenbrockIntegrator() {}
+
+State RosenbrockIntegrator::step(const State& state, double time) {
+  State new_state = State::Zero(size);
+  step(state, new_state, time);
+  return new_state;
+}
+
+void RosenbrockIntegrator::step(const State& state, State& new_state,
+                                double time) {
+  if (new_state.y.size() != size) {
+    new_state = State::Zero(size);
+  }
+  if (tolerance <= 0.0) {
+    substep(state, time, time_step_size, new_state);
+    num_steps++;
+    return;
+  }
+
+  // Sub-steps up to the end of the time step (a sub-step shortened to end
+  // there doesn't limit the next one)
+  double time_end = time + time_step_size;
+  double eps = 1.0e-10 * time_step_size;
+  State& current = substep_state;
+  current = state;
+  while (time < time_end - eps) {
+    double step_size = std::min(substep_size, time_end - time);
+    bool at_end = (step_size == time_end - time);
+    double error = substep(current, time, step_size, new_state);
+    if (!new_state.y.allFinite() && (step_size <= min_time_step_size)) {
+      throw std::runtime_error(
+          "Rosenbrock time step size below minimum at time " +
+          std::to_string(time));
+    }
+
+    // Sub-steps of the minimum size are accepted (e.g. at jumps of the
+    // solution)
+    double factor =
+        std::clamp(0.9 / std::sqrt(std::max(error, 1.0e-10)), 0.2, 2.0);
+    if (((error > 1.0) || !new_state.y.allFinite()) &&
+        (step_size > min_time_step_size)) {
+      num_rejected_steps++;
+      substep_size =
+          std::max(step_size * std::min(factor, 0.5), min_time_step_size);
+      continue;
+    }
+    num_steps++;
+    time += step_size;
+    current.swap(new_state);
+    double next_size = step_size * factor;
+    if (at_end && (factor >= 1.0)) {
+      next_size = std::max(next_size, substep_size);
+    }
+    substep_size = std::clamp(next_size, min_time_step_size, time_step_size);
+  }
+  new_state.swap(current);
+}
+
+double RosenbrockIntegrator::substep(const State& state, double time,
+                                     double step_size, State& new_state) {
+  double coeff = 1.0 / (gamma_ros2 * step_size);
+
+  // Time derivative of f (from the difference over the time step, times
+  // gamma * h)
+  y_stage = state.y;
+  ydot_stage = state.ydot;
+  model->update_time(system, time + step_size);
+  model->update_solution(system, y_stage, ydot_stage);
+  evaluate_f(y_stage, ydot_stage);
+  f_time = gamma_ros2 * system.residual;
+
+  // First stage: W * k1 = f + gamma * h * df/dt
+  model->update_time(system, time);
+  model->update_solution(system, y_stage, ydot_stage);
+  evaluate_f(y_stage, ydot_stage);
+  f_time -= gamma_ros2 * system.residual;
+  system.residual += f_time;
+  system.residual *= coeff;
+
+  // W / (gamma * h) = M / (gamma * h) + F + dC/dy
+  system.update_jacobian(coeff, 1.0);
+  system.factorize();
+  system.solve();
+  k1 = system.dydot;
+  mass_k1.noalias() = system.E * k1;
+  mass_k1.noalias() += system.dC_dydot * k1;
+
+  // Second stage: W * k2 = f - 2 * M * k1 - gamma * h * df/dt, where f - M *
+  // k1 is the residual of the stage with ydot = k1 (exact for a constant M)
+  y_stage = state.y + step_size * k1;
+  model->update_time(system, time + step_size);
+  model->update_solution(system, y_stage, k1);
+  system.update_residual(y_stage, k1);
+  system.residual -= mass_k1;
+  system.residual -= f_time;
+  system.residual *= coeff;
+  system.solve();
+  k2 = system.dydot;
+
+  // Solution and time derivative (exact for linear systems up to first
+  // order in the step size)
+  new_state.y = state.y + (1.5 * step_size) * k1 + (0.5 * step_size) * k2;
+  new_state.ydot = (2.0 - gamma_ros2) * k1 + (1.0 - gamma_ros2) * k2;
+  model->post_solve(new_state.y);
+  if (tolerance <= 0.0) {
+    return -1.0;
+  }
+
+  // Difference to the embedded first-order solution y + h * k1 (only for
+  // the differential degrees-of-freedom, since the algebraic ones of the
+  // initial state may be inconsistent)
+  if (differential.size() == 0) {
+    differential = system.get_differential_dofs();
+  }
+  y_scale = y_scale.cwiseMax(state.y.cwiseAbs());
+  y_stage = y_scale.cwiseMax(new_state.y.cwiseAbs());
+  y_stage = y_stage.cwiseMax(std::max(1.0e-6 * y_stage.maxCoeff(), 1.0e-12));
+  ydot_stage = (0.5 * step_size) * (k1 + k2);
+  ydot_stage = differential.select(ydot_stage.cwiseQuotient(y_stage), 0.0);
+  return std::sqrt(ydot_stage.squaredNorm() / size) / tolerance;
+}
+
+void RosenbrockIntegrator::evaluate_f(
+    Eigen::Matrix<double, Eigen::Dynamic, 1>& y,
+    Eigen::Matrix<double, Eigen::Dynamic, 1>& ydot) {
+  system.update_residual(y, ydot);
+  system.residual.noalias() += system.E * ydot;
+  system.residual.noalias() += system.dC_dydot * ydot;
+}
+
+int RosenbrockIntegrator::get_num_steps() const { return num_steps; }
+
+int RosenbrockIntegrator::get_num_rejected_steps() const {
+  return num_rejected_steps;
+}
+
+const LinearSolver& RosenbrockIntegrator::get_linear_solver() const {
+  return *system.solver;
+}
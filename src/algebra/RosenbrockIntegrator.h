@@ -0,0 +1,170 @@
+// SPDX-FileCopyrightText: Copyright (c) Stanford University, The Regents of the
+// University of California, and others. SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file RosenbrockIntegrator.h
+ * @brief RosenbrockIntegrator source file
+ */
+#ifndef SVZERODSOLVER_ALGEBRA_ROSENBROCKINTEGRATOR_HPP_
+#define SVZERODSOLVER_ALGEBRA_ROSENBROCKINTEGRATOR_HPP_
+
+#include <Eigen/Dense>
+#include <string>
+
+#include "Model.h"
+#include "SparseSystem.h"
+#include "State.h"
+
+/**
+ * @brief Linearly implicit Rosenbrock-W integrator
+ *
+ * This class integrates the system
+ *
+ * \f[
+ * \mathbf{E}(\mathbf{y}) \cdot \dot{\mathbf{y}}+\mathbf{F}(\mathbf{y}) \cdot
+ * \mathbf{y}+\mathbf{c}(\mathbf{y},\dot{\mathbf{y}}) = \mathbf{0}
+ * \f]
+ *
+ * with the two-stage, second-order, L-stable ROS2 method of Verwer et al.
+ * (1999). It is written as \f$\mathbf{M}\dot{\mathbf{y}} =
+ * \mathbf{f}(t, \mathbf{y})\f$ with the mass matrix \f$\mathbf{M} =
+ * \mathbf{E} + \partial \mathbf{c} / \partial \dot{\mathbf{y}}\f$ (the blocks
+ * are linear in \f$\dot{\mathbf{y}}\f$), i.e.
+ *
+ * \f[
+ * \mathbf{W} \mathbf{k}_1 = \mathbf{f}(t_n, \mathbf{y}_n) + \gamma h
+ * \mathbf{f}_t, \quad
+ * \mathbf{W} \mathbf{k}_2 = \mathbf{f}(t_n + h, \mathbf{y}_n + h
+ * \mathbf{k}_1) - 2 \mathbf{M} \mathbf{k}_1 - \gamma h \mathbf{f}_t,
+ * \quad
+ * \mathbf{y}_{n+1} = \mathbf{y}_n + \frac{h}{2} (3 \mathbf{k}_1 +
+ * \mathbf{k}_2)
+ * \f]
+ *
+ * with \f$\mathbf{W} = \mathbf{M} - \gamma h \mathbf{J}\f$, \f$\gamma = 1 +
+ * 1 / \sqrt{2}\f$, and the Jacobian \f$\mathbf{J} = -(\mathbf{F} + \partial
+ * \mathbf{c} / \partial \mathbf{y})\f$ at the start of the step. The time
+ * derivative \f$\mathbf{f}_t\f$ (of the time-dependent parameters) is
+ * approximated by the difference of \f$\mathbf{f}(\cdot, \mathbf{y}_n)\f$
+ * over the step. Each time step thus needs one factorization and two linear
+ * solves instead of the non-linear iterations of the generalized-\f$\alpha\f$
+ * method (see Integrator).
+ *
+ * With a tolerance, each time step is split into sub-steps that are
+ * controlled by the embedded first-order solution \f$\mathbf{y}_n + h
+ * \mathbf{k}_1\f$ (scaled root-mean-square error of the differential
+ * degrees-of-freedom, see SparseSystem::get_differential_dofs).
+ */
+class RosenbrockIntegrator {
+ public:
+  /**
+   * @brief Construct a new RosenbrockIntegrator object
+   *
+   * @param model The model to simulate
+   * @param time_step_size Time step size
+   * @param tolerance Tolerance of the scaled local error estimate of the
+   * sub-steps (0: no sub-steps)
+   * @param min_time_step_size Minimum size of the sub-steps
+   * @param linear_solver Name of the linear solver (see create_linear_solver)
+   * @param ordering Name of the fill-reducing column ordering of the linear
+   * solver
+   */
+  RosenbrockIntegrator(Model* model, double time_step_size, double tolerance,
+                       double min_time_step_size,
+                       const std::string& linear_solver = "sparse_lu",
+                       const std::string& ordering = "colamd");
+
+  /**
+   * @brief Construct a new RosenbrockIntegrator object
+   *
+   */
+  RosenbrockIntegrator();
+
+  /**
+   * @brief Destroy the RosenbrockIntegrator object
+   *
+   */
+  ~RosenbrockIntegrator();
+
+  /**
+   * @brief Perform a time step (split into sub-steps with a tolerance)
+   *
+   * @param state Current state
+   * @param time Current time
+   * @return New state
+   */
+  State step(const State& state, double time);
+
+  /**
+   * @brief Perform a time step in place (see Integrator::step)
+   *
+   * @param state Current state
+   * @param new_state New state (preallocated, not the current state)
+   * @param time Current time
+   */
+  void step(const State& state, State& new_state, double time);
+
+  /**
+   * @brief Get the number of accepted sub-steps
+   *
+   * @return int Number of sub-steps in all step calls
+   */
+  int get_num_steps() const;
+
+  /**
+   * @brief Get the number of rejected sub-steps
+   *
+   * @return int Number of rejected sub-steps in all step calls
+   */
+  int get_num_rejected_steps() const;
+
+  /**
+   * @brief Get the linear solver of the system
+   *
+   * @return const LinearSolver& Linear solver
+   */
+  const LinearSolver& get_linear_solver() const;
+
+ private:
+  /**
+   * @brief Perform a sub-step
+   *
+   * @param state State at the start of the sub-step
+   * @param time Time at the start of the sub-step
+   * @param step_size Size of the sub-step
+   * @param new_state State at the end of the sub-step
+   * @return double Scaled error estimate (negative without a tolerance)
+   */
+  double substep(const State& state, double time, double step_size,
+                 State& new_state);
+
+  /**
+   * @brief Evaluate f = residual + M * ydot (in `system.residual`) with the
+   * system of the last update_solution call
+   *
+   * @param y Solution
+   * @param ydot Time derivative of the solution
+   */
+  void evaluate_f(Eigen::Matrix<double, Eigen::Dynamic, 1>& y,
+                  Eigen::Matrix<double, Eigen::Dynamic, 1>& ydot);
+
+  Model* model{nullptr};
+  SparseSystem system;
+  double time_step_size{0.0};
+  double tolerance{0.0};
+  double min_time_step_size{0.0};
+  double substep_size{0.0};
+  int size{0};
+  int num_steps{0};
+  int num_rejected_steps{0};
+  Eigen::Matrix<double, Eigen::Dynamic, 1> k1;
+  Eigen::Matrix<double, Eigen::Dynamic, 1> k2;
+  Eigen::Matrix<double, Eigen::Dynamic, 1> mass_k1;
+  Eigen::Matrix<double, Eigen::Dynamic, 1> y_stage;
+  Eigen::Matrix<double, Eigen::Dynamic, 1> ydot_stage;
+  Eigen::Matrix<double, Eigen::Dynamic, 1> f_time;
+  Eigen::Matrix<double, Eigen::Dynamic, 1> y_scale;
+  Eigen::Array<bool, Eigen::Dynamic, 1> differential;
+  State substep_state;
+};
+
+#endif  // SVZERODSOLVER_ALGEBRA_ROSENBROCKINTEGRATOR_HPP_
@@ -27,6 +27,23 @@ void SparseSystem::clean() {
   // delete solver;
 }
 
+/**
+ * @brief Expand the sparsity pattern of a matrix
+ *
+ * @param matrix Matrix whose entries are a subset of the pattern
+ * @param pattern Compressed sparsity pattern with zero values
+ */
+static void expand_pattern(Eigen::SparseMatrix<double>& matrix,
+                           const Eigen::SparseMatrix<double>& pattern) {
+  Eigen::SparseMatrix<double> expanded = pattern;
+  for (int k = 0; k < matrix.outerSize(); ++k) {
+    for (Eigen::SparseMatrix<double>::InnerIterator it(matrix, k); it; ++it) {
+      expanded.coeffRef(it.row(), it.col()) = it.value();
+    }
+  }
+  matrix = expanded;
+}
+
 void SparseSystem::reserve(Model* model) {
   auto num_triplets = model->get_num_triplets();
   F.reserve(num_triplets.F);
@@ -34,6 +51,51 @@ void SparseSystem::reserve(Model* model) {
   dC_dy.reserve(num_triplets.D);
   dC_dydot.reserve(num_triplets.D);
 
+  model->update_constant(*this);
+
+  // Collect the entries of all matrices and the entries that blocks write in
+  // update_time and update_solution
+  std::vector<Eigen::Triplet<double>> triplets;
+  for (auto matrix : {&F, &E, &dC_dy, &dC_dydot}) {
+    for (int k = 0; k < matrix->outerSize(); ++k) {
+      for (Eigen::SparseMatrix<double>::InnerIterator it(*matrix, k); it;
+           ++it) {
+        triplets.push_back({(int)it.row(), (int)it.col(), 0.0});
+      }
+    }
+  }
+  auto slot_entries = model->get_slot_entries();
+  for (auto& [row, col] : slot_entries) {
+    triplets.push_back({row, col, 0.0});
+  }
+
+  // Common sparsity pattern of all system matrices and the jacobian
+  Eigen::SparseMatrix<double> pattern(F.rows(), F.cols());
+  pattern.setFromTriplets(triplets.begin(), triplets.end());
+  pattern.makeCompressed();
+  expand_pattern(F, pattern);
+  expand_pattern(E, pattern);
+  expand_pattern(dC_dy, pattern);
+  expand_pattern(dC_dydot, pattern);
+  jacobian = pattern;
+
+  // Look up the storage indices of the block entries once
+  slots.resize(slot_entries.size());
+  for (size_t i = 0; i < slot_entries.size(); i++) {
+    slots[i] = get_slot(slot_entries[i].first, slot_entries[i].second);
+  }
+
+  reset(model);
+  solver->analyze_pattern(jacobian);  // Let solver analyze pattern
+}
+
+void SparseSystem::reset(Model* model) {
+  for (auto matrix : {&F, &E, &dC_dy, &dC_dydot}) {
+    matrix->coeffs().setZero();
+  }
+  C.setZero();
+  residual.setZero();
+  dydot.setZero();
   model->update_constant(*this);
   model->update_time(*this, 0.0);
 
@@ -45,14 +107,19 @@ void SparseSystem::reserve(Model* model) {
 
   model->update_solution(*this, dummy_y, dummy_dy);
 
-  F.makeCompressed();
-  E.makeCompressed();
-  dC_dy.makeCompressed();
-  dC_dydot.makeCompressed();
-  jacobian.reserve(num_triplets.F + num_triplets.E);  // Just an estimate
-  update_jacobian(1.0, 1.0);  // Update it once to have sparsity pattern
-  jacobian.makeCompressed();
-  solver->analyzePattern(jacobian);  // Let solver analyze pattern
+  update_jacobian(1.0, 1.0);
+}
+
+int SparseSystem::get_slot(int row, int col) const {
+  auto begin = jacobian.innerIndexPtr() + jacobian.outerIndexPtr()[col];
+  auto end = jacobian.innerIndexPtr() + jacobian.outerIndexPtr()[col + 1];
+  auto it = std::lower_bound(begin, end, row);
+  if ((it == end) || (*it != row)) {
+    throw std::runtime_error("Entry (" + std::to_string(row) + ", " +
+                             std::to_string(col) +
+                             ") is not part of the sparsity pattern.");
+  }
+  return it - jacobian.innerIndexPtr();
 }
 
 void SparseSystem::update_residual(
@@ -66,18 +133,43 @@ void SparseSystem::update_residual(
 
 void SparseSystem::update_jacobian(double time_coeff_ydot,
                                    double time_coeff_y) {
-  jacobian.setZero();
-  jacobian += (E + dC_dydot) * time_coeff_ydot;
-  jacobian += (F + dC_dy) * time_coeff_y;
+  // Blocks must not insert new entries after reserve
+  if (!(F.isCompressed() && E.isCompressed() && dC_dy.isCompressed() &&
+        dC_dydot.isCompressed())) {
+    throw std::runtime_error(
+        "Sparsity pattern of the system changed after reserve. Register all "
+        "entries written in update_time and update_solution in "
+        "Block::slot_entries.");
+  }
+
+  const double* e = E.valuePtr();
+  const double* f = F.valuePtr();
+  const double* dc_dy = dC_dy.valuePtr();
+  const double* dc_dydot = dC_dydot.valuePtr();
+  double* jac = jacobian.valuePtr();
+  for (int k = 0; k < jacobian.nonZeros(); k++) {
+    jac[k] = (e[k] + dc_dydot[k]) * time_coeff_ydot +
+             (f[k] + dc_dy[k]) * time_coeff_y;
+  }
 }
 
-void SparseSystem::solve() {
-  solver->factorize(jacobian);
-  if (solver->info() != Eigen::Success) {
-    throw std::runtime_error(
-        "System is singular. Check your model (connections, boundary "
-        "conditions, parameters).");
+Eigen::Array<bool, Eigen::Dynamic, 1> SparseSystem::get_differential_dofs()
+    const {
+  Eigen::Array<bool, Eigen::Dynamic, 1> differential =
+      Eigen::Array<bool, Eigen::Dynamic, 1>::Constant(E.cols(), false);
+  for (auto matrix : {&E, &dC_dydot}) {
+    for (int k = 0; k < matrix->outerSize(); ++k) {
+      for (Eigen::SparseMatrix<double>::InnerIterator it(*matrix, k); it;
+           ++it) {
+        if (it.value() != 0.0) {
+          differential[it.col()] = true;
+        }
+      }
+    }
   }
-  dydot.setZero();
-  dydot += solver->solve(residual);
+  return differential;
 }
+
+void SparseSystem::factorize() { solver->factorize(jacobian); }
+
+void SparseSystem::solve() { solver->solve(residual, dydot); }
@@ -8,9 +8,11 @@
 #define SVZERODSOLVER_ALGREBRA_SPARSESYSTEM_HPP_
 
 #include <Eigen/Sparse>
-#include <Eigen/SparseLU>
 #include <iostream>
 #include <memory>
+#include <vector>
+
+#include "LinearSolver.h"
 
 // Forward declaration of Model
 class Model;
@@ -55,23 +57,50 @@ class SparseSystem {
   Eigen::Matrix<double, Eigen::Dynamic, 1> C;  ///< System vector C
 
   Eigen::SparseMatrix<double> jacobian;  ///< Jacobian of the system
+  std::vector<int> slots;  ///< Storage indices of the entries that blocks write
+                           ///< in update_time and update_solution
   Eigen::Matrix<double, Eigen::Dynamic, 1>
       residual;  ///< Residual of the system
   Eigen::Matrix<double, Eigen::Dynamic, 1>
       dydot;  ///< Solution increment of the system
 
-  std::shared_ptr<Eigen::SparseLU<Eigen::SparseMatrix<double>>> solver =
-      std::shared_ptr<Eigen::SparseLU<Eigen::SparseMatrix<double>>>(
-          new Eigen::SparseLU<Eigen::SparseMatrix<double>>());  ///< Linear
-                                                                ///< solver
+  std::shared_ptr<LinearSolver> solver =
+      create_linear_solver();  ///< Linear solver
 
   /**
-   * @brief Reserve memory in system matrices based on number of triplets
+   * @brief Reserve memory in system matrices and set up the sparsity pattern
+   *
+   * All system matrices (F, E, dC/dy, dC/dydot) and the jacobian share one
+   * compressed sparsity pattern, which is the union of the entries written in
+   * Block::update_constant and the entries registered by the blocks in
+   * Block::slot_entries. The storage indices of the registered entries are
+   * looked up once and stored in \ref slots. The pattern must not change
+   * afterwards.
    *
    * @param model The model to reserve space for in the system
    */
   void reserve(Model* model);
 
+  /**
+   * @brief Reset the values of the system to those after reserve
+   *
+   * Keeps the sparsity pattern and its analysis by the linear solver, such
+   * that a simulation with a system that is reset gives the same result as
+   * with a new one (e.g. after updating the parameters of the model).
+   *
+   * @param model The model of the system
+   */
+  void reset(Model* model);
+
+  /**
+   * @brief Get the storage index of an entry in the sparsity pattern
+   *
+   * @param row Row of the entry
+   * @param col Column of the entry
+   * @return int Index of the entry in the value arrays of the system matrices
+   */
+  int get_slot(int row, int col) const;
+
   /**
    * @brief Update the residual of the system
    *
@@ -84,19 +113,38 @@ class SparseSystem {
   /**
    * @brief Update the jacobian of the system
    *
+   * Since all system matrices share the sparsity pattern of the jacobian, this
+   * is a single pass over the value arrays.
+   *
    * @param time_coeff_ydot Coefficent ydot-dependent part of jacobian
    * @param time_coeff_y Coefficent ydot-dependent part of jacobian
    */
   void update_jacobian(double time_coeff_ydot, double time_coeff_y);
 
   /**
-   * @brief Solve the system
+   * @brief Factorize the jacobian of the system
+   */
+  void factorize();
+
+  /**
+   * @brief Solve the system with the last factorization of the jacobian
    */
   void solve();
 
+  /**
+   * @brief Get the differential degrees-of-freedom
+   *
+   * A degree-of-freedom is differential if the system depends on its time
+   * derivative (non-zero column of E or dC/dydot). The others are algebraic.
+   *
+   * @return Eigen::Array<bool, Eigen::Dynamic, 1> True for differential
+   * degrees-of-freedom
+   */
+  Eigen::Array<bool, Eigen::Dynamic, 1> get_differential_dofs() const;
+
   /**
    * @brief Delete dynamically allocated memory (class member
-   * Eigen::SparseLU<Eigen::SparseMatrix> *solver)
+   * LinearSolver *solver)
    */
   void clean();
 };
@@ -17,10 +17,15 @@ State::State(const State& state) {
   ydot = state.ydot;
 }
 
+void State::swap(State& state) {
+  y.swap(state.y);
+  ydot.swap(state.ydot);
+}
+
 State State::Zero(int n) {
-  // [TODO] what's going on here, returing a static State?
-  static State state(n);
-  state.y = Eigen::Matrix<double, Eigen::Dynamic, 1>::Zero(n);
-  state.ydot = Eigen::Matrix<double, Eigen::Dynamic, 1>::Zero(n);
+  // Not a static State, which could be shared between threads
+  State state(n);
+  state.y.setZero();
+  state.ydot.setZero();
   return state;
 }
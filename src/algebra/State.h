@@ -48,6 +48,14 @@ class State {
    */
   State(const State& state);
 
+  /**
+   * @brief Exchange the vectors with another State object (without copying
+   * or allocating them, e.g. to double-buffer the states of a time loop)
+   *
+   * @param state Other state
+   */
+  void swap(State& state);
+
   /**
    * @brief Construct a new State object and initilaize with all zeros.
    *
@@ -0,0 +1,122 @@
+// SPDX-FileCopyrightText: Copyright (c) Stanford University, The Regents of the
+// University of California, and others. SPDX-License-Identifier: BSD-3-Clause
+
+#include "SteadySolver.h"
+
+#include <stdexcept>
+
+#include "Integrator.h"
+#include "debug.h"
+
+SteadySolver::SteadySolver(Model* model, double time_step_size, double rho,
+                           double atol, int max_iter,
+                           const std::string& linear_solver,
+                           const std::string& ordering)
+    : model(model),
+      time_step_size(time_step_size),
+      rho(rho),
+      atol(atol),
+      max_iter(max_iter),
+      linear_solver(linear_solver),
+      ordering(ordering) {
+  int size = model->dofhandler.size();
+  system = SparseSystem(size);
+  system.solver = create_linear_solver(linear_solver, ordering);
+  system.reserve(model);
+  ydot = Eigen::Matrix<double, Eigen::Dynamic, 1>::Zero(size);
+}
+
+// Must declare destructor because of Eigen.
+SteadySolver::~SteadySolver() {}
+
+State SteadySolver::solve(const State& state) {
+  State steady_state = State::Zero(state.y.size());
+  steady_state.y = state.y;
+  bool time_invariant = model->is_steady_time_invariant();
+  model->update_time(system, 0.0);
+  if (time_invariant && newton(steady_state.y)) {
+    return steady_state;
+  }
+
+  // Pseudo-transient continuation (the number of time steps of the former
+  // steady initial condition)
+  DEBUG_MSG("Steady state: Continue pseudo-transient");
+  const int num_steps = 31;
+  Integrator integrator(model, time_step_size, rho, atol, max_iter,
+                        linear_solver, ordering);
+  State transient_state = state;
+  for (int i = 0; i < num_steps; i++) {
+    transient_state =
+        integrator.step(transient_state, time_step_size * double(i));
+    num_pseudo_transient_steps++;
+  }
+
+  // Keep the result of the continuation if the Newton method fails again
+  steady_state.y = transient_state.y;
+  model->update_time(system, 0.0);
+  if (time_invariant && newton(steady_state.y)) {
+    return steady_state;
+  }
+  return transient_state;
+}
+
+bool SteadySolver::newton(Eigen::Matrix<double, Eigen::Dynamic, 1>& y) {
+  // Minimum damping of the Newton increment and sufficient decrease of the
+  // squared residual norm per unit damping (Armijo condition)
+  const double min_damping = 1.0 / 1024.0;
+  const double sufficient_decrease = 1.0e-4;
+
+  update_residual(y);
+  double residual_norm = system.residual.squaredNorm();
+  for (int i = 0; i < max_iter; i++) {
+    if (system.residual.cwiseAbs().maxCoeff() < atol) {
+      return true;
+    }
+
+    // Jacobian of the steady system is F + dC/dy
+    system.update_jacobian(0.0, 1.0);
+    try {
+      system.factorize();
+    } catch (const std::runtime_error&) {
+      return false;
+    }
+    system.solve();
+    Eigen::Matrix<double, Eigen::Dynamic, 1> increment = system.dydot;
+    if (!increment.allFinite()) {
+      return false;
+    }
+    num_iterations++;
+
+    // Halve the increment until the residual decreases sufficiently (or
+    // converges)
+    Eigen::Matrix<double, Eigen::Dynamic, 1> y_new;
+    for (double damping = 1.0;; damping *= 0.5) {
+      if (damping < min_damping) {
+        return false;
+      }
+      y_new = y + damping * increment;
+      update_residual(y_new);
+      double residual_norm_new = system.residual.squaredNorm();
+      if ((residual_norm_new <=
+           (1.0 - sufficient_decrease * damping) * residual_norm) ||
+          (system.residual.cwiseAbs().maxCoeff() < atol)) {
+        residual_norm = residual_norm_new;
+        break;
+      }
+    }
+    y = y_new;
+  }
+  return system.residual.cwiseAbs().maxCoeff() < atol;
+}
+
+void SteadySolver::update_residual(
+    Eigen::Matrix<double, Eigen::Dynamic, 1>& y) {
+  model->update_solution(system, y, ydot);
+  system.update_residual(y, ydot);
+}
+
+int SteadySolver::get_num_iterations() const { return num_iterations; }
+
+int SteadySolver::get_num_pseudo_transient_steps() const {
+  return num_pseudo_transient_steps;
+}
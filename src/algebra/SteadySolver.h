@@ -0,0 +1,118 @@
+// SPDX-FileCopyrightText: Copyright (c) Stanford University, The Regents of the
+// University of California, and others. SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file SteadySolver.h
+ * @brief SteadySolver source file
+ */
+#ifndef SVZERODSOLVER_ALGEBRA_STEADYSOLVER_HPP_
+#define SVZERODSOLVER_ALGEBRA_STEADYSOLVER_HPP_
+
+#include <Eigen/Dense>
+#include <string>
+
+#include "Model.h"
+#include "SparseSystem.h"
+#include "State.h"
+
+/**
+ * @brief Steady state solver
+ *
+ * This class computes the steady state of a model (e.g. the steady initial
+ * condition after Model::to_steady), i.e. the solution of
+ *
+ * \f[
+ * \mathbf{F}(\mathbf{y}) \cdot \mathbf{y} + \mathbf{c}(\mathbf{y}) =
+ * \mathbf{0}
+ * \f]
+ *
+ * with \f$\dot{\mathbf{y}} = \mathbf{0}\f$. It uses the damped Newton method
+ * on the system matrices of the model: the Newton increment is halved until
+ * the 2-norm of the residual decreases (Armijo condition). The iterations
+ * have converged once the maximum absolute residual is below the tolerance.
+ *
+ * Only if the Newton method fails (no descent, singular Jacobian, or too many
+ * iterations), the steady state is approached with pseudo-transient
+ * continuation: time steps of the generalized-\f$\alpha\f$ integrator (see
+ * Integrator) with a large time step size, followed by another attempt of
+ * the Newton method. Models that still depend on time in their steady
+ * behavior (see Model::is_steady_time_invariant) have no steady state. Their
+ * "steady" state is the result of the pseudo-transient continuation.
+ */
+class SteadySolver {
+ public:
+  /**
+   * @brief Construct a new SteadySolver object
+   *
+   * @param model The model (with the parameters of the steady state)
+   * @param time_step_size Time step size of the pseudo-transient continuation
+   * @param rho Spectral radius of the pseudo-transient continuation
+   * @param atol Absolute tolerance of the residual
+   * @param max_iter Maximum number of Newton iterations
+   * @param linear_solver Name of the linear solver (see create_linear_solver)
+   * @param ordering Name of the fill-reducing column ordering of the linear
+   * solver
+   */
+  SteadySolver(Model* model, double time_step_size, double rho, double atol,
+               int max_iter, const std::string& linear_solver = "sparse_lu",
+               const std::string& ordering = "colamd");
+
+  /**
+   * @brief Destroy the SteadySolver object
+   *
+   */
+  ~SteadySolver();
+
+  /**
+   * @brief Compute the steady state
+   *
+   * @param state Initial guess
+   * @return State Steady state (with zero time derivative if the Newton
+   * method converged)
+   */
+  State solve(const State& state);
+
+  /**
+   * @brief Get the number of Newton iterations in all solve calls
+   *
+   * @return int Number of Newton iterations
+   */
+  int get_num_iterations() const;
+
+  /**
+   * @brief Get the number of pseudo-transient time steps in all solve calls
+   *
+   * @return int Number of pseudo-transient time steps (zero unless the
+   * Newton method failed)
+   */
+  int get_num_pseudo_transient_steps() const;
+
+ private:
+  /**
+   * @brief Perform the damped Newton iterations
+   *
+   * @param y Initial guess (overwritten with the last iterate)
+   * @return bool True if the iterations converged
+   */
+  bool newton(Eigen::Matrix<double, Eigen::Dynamic, 1>& y);
+
+  /**
+   * @brief Evaluate the residual of the steady system (in `system.residual`)
+   *
+   * @param y Solution
+   */
+  void update_residual(Eigen::Matrix<double, Eigen::Dynamic, 1>& y);
+
+  Model* model{nullptr};
+  SparseSystem system;
+  Eigen::Matrix<double, Eigen::Dynamic, 1> ydot;
+  double time_step_size{0.0};
+  double rho{0.0};
+  double atol{0.0};
+  int max_iter{0};
+  std::string linear_solver;
+  std::string ordering;
+  int num_iterations{0};
+  int num_pseudo_transient_steps{0};
+};
+
+#endif  // SVZERODSOLVER_ALGEBRA_STEADYSOLVER_HPP_
@@ -91,6 +91,8 @@ void initialize(std::string input_file_arg, int& problem_id, int& pts_per_cycle,
   auto model = std::shared_ptr<Model>(new Model());
 
   load_simulation_model(config, *model.get());
+  model->set_parameter_interpolation(simparams.sim_parameter_interpolation,
+                                     simparams.sim_parameter_resampling_points);
   auto state = load_initial_condition(config, *model.get());
 
   // Check that steady initial is not set when ClosedLoopHeartAndPulmonary is
@@ -101,6 +103,13 @@ void initialize(std::string input_file_arg, int& problem_id, int& pts_per_cycle,
         "ClosedLoopHeartAndPulmonary block.");
   }
 
+  // Check that Jacobian reuse is not used with blocks that modify the solution
+  if ((simparams.sim_jacobian_reuse_steps > 0) && model->modifies_solution()) {
+    throw std::runtime_error(
+        "ERROR: Jacobian reuse is not compatible with blocks that modify the "
+        "solution (e.g. ClosedLoopHeartAndPulmonary).");
+  }
+
   // Set default cardiac cycle period if not set by model
   if (model->cardiac_cycle_period < 0.0) {
     model->cardiac_cycle_period =
@@ -131,6 +140,10 @@ void initialize(std::string input_file_arg, int& problem_id, int& pts_per_cycle,
   interface->rho_infty_ = simparams.sim_rho_infty;
   interface->max_nliter_ = simparams.sim_nliter;
   interface->absolute_tolerance_ = simparams.sim_abs_tol;
+  interface->linear_solver_ = simparams.linear_solver;
+  interface->linear_solver_ordering_ = simparams.linear_solver_ordering;
+  interface->jacobian_reuse_steps_ = simparams.sim_jacobian_reuse_steps;
+  interface->jacobian_reuse_rate_ = simparams.sim_jacobian_reuse_rate;
   interface->time_step_ = 0;
   interface->system_size_ = model->dofhandler.size();
   interface->num_time_steps_ = simparams.sim_num_time_steps;
@@ -167,13 +180,11 @@ void initialize(std::string input_file_arg, int& problem_id, int& pts_per_cycle,
 
     auto model_steady = model;
     model_steady->to_steady();
-    Integrator integrator_steady(
+    SteadySolver steady_solver(
         model_steady.get(), time_step_size_steady, interface->rho_infty_,
-        interface->absolute_tolerance_, interface->max_nliter_);
-
-    for (size_t i = 0; i < 31; i++) {
-      state = integrator_steady.step(state, time_step_size_steady * double(i));
-    }
+        interface->absolute_tolerance_, interface->max_nliter_,
+        interface->linear_solver_, interface->linear_solver_ordering_);
+    state = steady_solver.solve(state);
     model_steady->to_unsteady();
   }
 
@@ -186,7 +197,10 @@ void initialize(std::string input_file_arg, int& problem_id, int& pts_per_cycle,
   // Initialize integrator
   interface->integrator_ =
       Integrator(model.get(), interface->time_step_size_, interface->rho_infty_,
-                 interface->absolute_tolerance_, interface->max_nliter_);
+                 interface->absolute_tolerance_, interface->max_nliter_,
+                 interface->linear_solver_, interface->linear_solver_ordering_,
+                 interface->jacobian_reuse_steps_,
+                 interface->jacobian_reuse_rate_);
 
   DEBUG_MSG("[initialize] Done");
 }
@@ -208,7 +222,12 @@ void set_external_step_size(int problem_id, double external_step_size) {
   // Update time step size in interface
   double zerod_step_size =
       external_step_size / (double(interface->num_time_steps_) - 1.0);
-  interface->time_step_size_ = zerod_step_size;
+  if (zerod_step_size != interface->time_step_size_) {
+    interface->time_step_size_ = zerod_step_size;
+    // The persistent integrator only needs to be set up again if the time
+    // step size has actually changed
+    interface->integrator_.update_params(zerod_step_size);
+  }
 }
 
 /**
@@ -257,6 +276,9 @@ void update_block_params(int problem_id, std::string block_name,
       // because it is handled in Model::update_time
       model->update_parameter_value(block->global_param_ids[i], params[i]);
     }
+    // Constant parameters are assembled into the system of the persistent
+    // integrator only once, so the system has to be updated here
+    interface->integrator_.update_params(interface->time_step_size_);
   }
 }
 
@@ -398,15 +420,11 @@ void update_state(int problem_id, std::vector<double> new_state_y,
 void increment_time(int problem_id, const double external_time,
                     std::vector<double>& solution) {
   auto interface = SolverInterface::interface_list_[problem_id];
-  auto model = interface->model_;
 
-  auto time_step_size = interface->time_step_size_;
-  auto absolute_tolerance = interface->absolute_tolerance_;
-  auto max_nliter = interface->max_nliter_;
-  Integrator integrator(model.get(), time_step_size, interface->rho_infty_,
-                        absolute_tolerance, max_nliter);
+  // Reuse the persistent integrator. Its system is kept up to date by
+  // set_external_step_size and update_block_params.
   auto state = interface->state_;
-  interface->state_ = integrator.step(state, external_time);
+  interface->state_ = interface->integrator_.step(state, external_time);
   interface->time_step_ += 1;
 
   for (int i = 0; i < state.y.size(); i++) {
@@ -439,7 +457,7 @@ void run_simulation(int problem_id, const double external_time,
   auto system_size = interface->system_size_;
   auto num_output_steps = interface->num_output_steps_;
 
-  auto integrator = interface->integrator_;
+  auto& integrator = interface->integrator_;
   integrator.update_params(time_step_size);
 
   auto state = interface->state_;
@@ -14,6 +14,7 @@
 #include "Model.h"
 #include "SparseSystem.h"
 #include "State.h"
+#include "SteadySolver.h"
 #include "csv_writer.h"
 #include "debug.h"
 
@@ -82,6 +83,22 @@ class SolverInterface {
    * @brief Maximum number of non-linear iterations
    */
   int max_nliter_ = 0;
+  /**
+   * @brief Linear solver
+   */
+  std::string linear_solver_ = "sparse_lu";
+  /**
+   * @brief Fill-reducing column ordering of the linear solver
+   */
+  std::string linear_solver_ordering_ = "colamd";
+  /**
+   * @brief Maximum number of time steps with a reused Jacobian factorization
+   */
+  int jacobian_reuse_steps_ = 0;
+  /**
+   * @brief Maximum residual ratio of iterations with a reused factorization
+   */
+  double jacobian_reuse_rate_ = 0.5;
   /**
    * @brief Current time step
    */
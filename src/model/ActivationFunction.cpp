@@ -19,15 +19,38 @@ ActivationFunction::ActivationFunction(
       input_param_properties(input_param_properties) {
   // Initialize parameters with default values
   for (const auto& p : this->input_param_properties) {
-    if (p.second.is_number) {
-      double default_val = p.second.is_optional ? p.second.default_val : 0.0;
-      params_[p.first] = default_val;
-    }
+    double default_val = (p.second.is_number && p.second.is_optional)
+                             ? p.second.default_val
+                             : 0.0;
+    params_.push_back(default_val);
   }
 }
 
 void ActivationFunction::set_param(const std::string& name, double value) {
-  params_[name] = value;
+  for (size_t i = 0; i < input_param_properties.size(); i++) {
+    if (input_param_properties[i].first == name) {
+      params_[i] = value;
+      return;
+    }
+  }
+  throw std::runtime_error("Unknown activation function parameter " + name);
+}
+
+void ActivationFunction::compute(const std::vector<double>& times,
+                                 std::vector<double>& values) {
+  values.resize(times.size());
+  for (size_t i = 0; i < times.size(); i++) {
+    values[i] = compute(times[i]);
+  }
+}
+
+void ActivationFunction::tabulate(const std::vector<double>& times,
+                                  double cardiac_period) {
+  table_.clear();
+  if (cardiac_period != cardiac_period_) {
+    return;
+  }
+  compute(times, table_);
 }
 
 std::unique_ptr<ActivationFunction> ActivationFunction::create_default(
@@ -46,10 +69,12 @@ std::unique_ptr<ActivationFunction> ActivationFunction::create_default(
       "'. Must be one of: half_cosine, piecewise_cosine, two_hill");
 }
 
-double HalfCosineActivation::compute(double time) {
-  double t_in_cycle = std::fmod(time, cardiac_period_);
-  const double t_active = params_.at("t_active");
-  const double t_twitch = params_.at("t_twitch");
+// The activation functions evaluated with the parameters in local variables,
+// shared by the compute functions for one and for many time points
+
+static double half_cosine(double time, double cardiac_period, double t_active,
+                          double t_twitch) {
+  double t_in_cycle = std::fmod(time, cardiac_period);
 
   double t_contract = 0.0;
   if (t_in_cycle >= t_active) {
@@ -64,21 +89,18 @@ double HalfCosineActivation::compute(double time) {
   return act;
 }
 
-double PiecewiseCosineActivation::compute(double time) {
-  const double contract_start = params_.at("contract_start");
-  const double relax_start = params_.at("relax_start");
-  const double contract_duration = params_.at("contract_duration");
-  const double relax_duration = params_.at("relax_duration");
-
+static double piecewise_cosine(double time, double cardiac_period,
+                               double contract_start, double relax_start,
+                               double contract_duration,
+                               double relax_duration) {
   double phi = 0.0;
-  double piecewise_condition =
-      std::fmod(time - contract_start, cardiac_period_);
+  double piecewise_condition = std::fmod(time - contract_start, cardiac_period);
 
   if (0.0 <= piecewise_condition && piecewise_condition < contract_duration) {
     phi = 0.5 *
           (1.0 - std::cos((M_PI * piecewise_condition) / contract_duration));
   } else {
-    piecewise_condition = std::fmod(time - relax_start, cardiac_period_);
+    piecewise_condition = std::fmod(time - relax_start, cardiac_period);
     if (0.0 <= piecewise_condition && piecewise_condition < relax_duration) {
       phi =
           0.5 * (1.0 + std::cos((M_PI * piecewise_condition) / relax_duration));
@@ -88,6 +110,64 @@ double PiecewiseCosineActivation::compute(double time) {
   return phi;
 }
 
+static double two_hill(double time, double cardiac_period,
+                       double normalization_factor, double t_shift,
+                       double tau_1, double tau_2, double m1, double m2) {
+  double t_in_cycle = std::fmod(time, cardiac_period);
+  double t_shifted = std::fmod(t_in_cycle - t_shift, cardiac_period);
+  t_shifted = (t_shifted >= 0.0) ? t_shifted : t_shifted + cardiac_period;
+
+  double g1 = std::pow(t_shifted / tau_1, m1);
+  double g2 = std::pow(t_shifted / tau_2, m2);
+
+  return normalization_factor * (g1 / (1.0 + g1)) * (1.0 / (1.0 + g2));
+}
+
+double HalfCosineActivation::compute(double time) {
+  return half_cosine(time, cardiac_period_, params_[ParamId::T_ACTIVE],
+                     params_[ParamId::T_TWITCH]);
+}
+
+void HalfCosineActivation::compute(const std::vector<double>& times,
+                                   std::vector<double>& values) {
+  const double t_active = params_[ParamId::T_ACTIVE];
+  const double t_twitch = params_[ParamId::T_TWITCH];
+  values.resize(times.size());
+  for (size_t i = 0; i < times.size(); i++) {
+    values[i] = half_cosine(times[i], cardiac_period_, t_active, t_twitch);
+  }
+}
+
+std::unique_ptr<ActivationFunction> HalfCosineActivation::clone() const {
+  return std::make_unique<HalfCosineActivation>(*this);
+}
+
+double PiecewiseCosineActivation::compute(double time) {
+  return piecewise_cosine(time, cardiac_period_,
+                          params_[ParamId::CONTRACT_START],
+                          params_[ParamId::RELAX_START],
+                          params_[ParamId::CONTRACT_DURATION],
+                          params_[ParamId::RELAX_DURATION]);
+}
+
+void PiecewiseCosineActivation::compute(const std::vector<double>& times,
+                                        std::vector<double>& values) {
+  const double contract_start = params_[ParamId::CONTRACT_START];
+  const double relax_start = params_[ParamId::RELAX_START];
+  const double contract_duration = params_[ParamId::CONTRACT_DURATION];
+  const double relax_duration = params_[ParamId::RELAX_DURATION];
+  values.resize(times.size());
+  for (size_t i = 0; i < times.size(); i++) {
+    values[i] = piecewise_cosine(times[i], cardiac_period_, contract_start,
+                                 relax_start, contract_duration,
+                                 relax_duration);
+  }
+}
+
+std::unique_ptr<ActivationFunction> PiecewiseCosineActivation::clone() const {
+  return std::make_unique<PiecewiseCosineActivation>(*this);
+}
+
 void TwoHillActivation::calculate_normalization_factor() {
   if (cardiac_period_ <= 0.0) {
     throw std::runtime_error(
@@ -96,10 +176,10 @@ void TwoHillActivation::calculate_normalization_factor() {
         std::to_string(cardiac_period_) + ")");
   }
 
-  const double tau_1 = params_.at("tau_1");
-  const double tau_2 = params_.at("tau_2");
-  const double m1 = params_.at("m1");
-  const double m2 = params_.at("m2");
+  const double tau_1 = params_[ParamId::TAU_1];
+  const double tau_2 = params_[ParamId::TAU_2];
+  const double m1 = params_[ParamId::M1];
+  const double m2 = params_[ParamId::M2];
 
   constexpr double NORMALIZATION_DT = 1e-5;
   double max_value = 0.0;
@@ -133,18 +213,31 @@ double TwoHillActivation::compute(double time) {
         "TwoHillActivation: call finalize() after setting parameters");
   }
 
-  const double t_shift = params_.at("t_shift");
-  const double tau_1 = params_.at("tau_1");
-  const double tau_2 = params_.at("tau_2");
-  const double m1 = params_.at("m1");
-  const double m2 = params_.at("m2");
+  return two_hill(time, cardiac_period_, normalization_factor_,
+                  params_[ParamId::T_SHIFT], params_[ParamId::TAU_1],
+                  params_[ParamId::TAU_2], params_[ParamId::M1],
+                  params_[ParamId::M2]);
+}
 
-  double t_in_cycle = std::fmod(time, cardiac_period_);
-  double t_shifted = std::fmod(t_in_cycle - t_shift, cardiac_period_);
-  t_shifted = (t_shifted >= 0.0) ? t_shifted : t_shifted + cardiac_period_;
+void TwoHillActivation::compute(const std::vector<double>& times,
+                                std::vector<double>& values) {
+  if (!normalization_initialized_) {
+    throw std::runtime_error(
+        "TwoHillActivation: call finalize() after setting parameters");
+  }
 
-  double g1 = std::pow(t_shifted / tau_1, m1);
-  double g2 = std::pow(t_shifted / tau_2, m2);
+  const double t_shift = params_[ParamId::T_SHIFT];
+  const double tau_1 = params_[ParamId::TAU_1];
+  const double tau_2 = params_[ParamId::TAU_2];
+  const double m1 = params_[ParamId::M1];
+  const double m2 = params_[ParamId::M2];
+  values.resize(times.size());
+  for (size_t i = 0; i < times.size(); i++) {
+    values[i] = two_hill(times[i], cardiac_period_, normalization_factor_,
+                         t_shift, tau_1, tau_2, m1, m2);
+  }
+}
 
-  return normalization_factor_ * (g1 / (1.0 + g1)) * (1.0 / (1.0 + g2));
+std::unique_ptr<ActivationFunction> TwoHillActivation::clone() const {
+  return std::make_unique<TwoHillActivation>(*this);
 }
@@ -9,7 +9,6 @@
 #ifndef SVZERODSOLVER_MODEL_ACTIVATIONFUNCTION_HPP_
 #define SVZERODSOLVER_MODEL_ACTIVATIONFUNCTION_HPP_
 
-#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -56,6 +55,59 @@ class ActivationFunction {
    */
   virtual double compute(double time) = 0;
 
+  /**
+   * @brief Compute activation values at many time points
+   *
+   * Gives the same values as calling compute for each time.
+   *
+   * @param times Time points
+   * @param values Activation values at the time points (resized to the number
+   * of time points)
+   */
+  virtual void compute(const std::vector<double>& times,
+                       std::vector<double>& values);
+
+  /**
+   * @brief Create a copy of the activation function
+   *
+   * @return Unique pointer to the copy
+   */
+  virtual std::unique_ptr<ActivationFunction> clone() const = 0;
+
+  /**
+   * @brief Get activation value at given time
+   *
+   * Reads the value from the table (see tabulate) if the table index is
+   * valid and computes it otherwise.
+   *
+   * @param time Current time
+   * @param table_index Index of the time in the table (-1: not tabulated)
+   * @return Activation value between 0 and 1
+   */
+  double get(double time, int table_index) {
+    if ((table_index >= 0) && (table_index < int(table_.size()))) {
+      return table_[table_index];
+    }
+    return compute(time);
+  }
+
+  /**
+   * @brief Tabulate the activation values at the time steps of a cardiac
+   * cycle
+   *
+   * The table is left empty if the activation function is not periodic with
+   * the given cardiac cycle period.
+   *
+   * @param times Times of the table entries
+   * @param cardiac_period Cardiac cycle period of the times
+   */
+  void tabulate(const std::vector<double>& times, double cardiac_period);
+
+  /**
+   * @brief Clear the table of activation values
+   */
+  void clear_table() { table_.clear(); }
+
   /**
    * @brief Create a default activation function from activation function type
    *
@@ -69,7 +121,9 @@ class ActivationFunction {
   /**
    * @brief Set a scalar parameter value by name.
    *
-   * Calling function must validate the parameter name and value
+   * The name is resolved to the index of the parameter in
+   * input_param_properties, where compute reads it from. Calling function
+   * must validate the parameter value.
    *
    * @param name Parameter name
    * @param value Parameter value
@@ -90,9 +144,14 @@ class ActivationFunction {
   double cardiac_period_;
 
   /**
-   * @brief Map of parameter names to their values
+   * @brief Parameter values in the order of input_param_properties
+   */
+  std::vector<double> params_;
+
+  /**
+   * @brief Tabulated activation values (see tabulate)
    */
-  std::map<std::string, double> params_;
+  std::vector<double> table_;
 };
 
 /**
@@ -123,7 +182,21 @@ class HalfCosineActivation : public ActivationFunction {
       : ActivationFunction(cardiac_period, {{"t_active", InputParameter()},
                                             {"t_twitch", InputParameter()}}) {}
 
+  /**
+   * @brief Local IDs of the parameters
+   *
+   */
+  enum ParamId {
+    T_ACTIVE = 0,
+    T_TWITCH = 1,
+  };
+
   double compute(double time) override;
+
+  void compute(const std::vector<double>& times,
+               std::vector<double>& values) override;
+
+  std::unique_ptr<ActivationFunction> clone() const override;
 };
 
 /**
@@ -160,7 +233,23 @@ class PiecewiseCosineActivation : public ActivationFunction {
                             {"contract_duration", InputParameter()},
                             {"relax_duration", InputParameter()}}) {}
 
+  /**
+   * @brief Local IDs of the parameters
+   *
+   */
+  enum ParamId {
+    CONTRACT_START = 0,
+    RELAX_START = 1,
+    CONTRACT_DURATION = 2,
+    RELAX_DURATION = 3,
+  };
+
   double compute(double time) override;
+
+  void compute(const std::vector<double>& times,
+               std::vector<double>& values) override;
+
+  std::unique_ptr<ActivationFunction> clone() const override;
 };
 
 /**
@@ -201,8 +290,25 @@ class TwoHillActivation : public ActivationFunction {
         normalization_factor_(1.0),
         normalization_initialized_(false) {}
 
+  /**
+   * @brief Local IDs of the parameters
+   *
+   */
+  enum ParamId {
+    T_SHIFT = 0,
+    TAU_1 = 1,
+    TAU_2 = 2,
+    M1 = 3,
+    M2 = 4,
+  };
+
   double compute(double time) override;
 
+  void compute(const std::vector<double>& times,
+               std::vector<double>& values) override;
+
+  std::unique_ptr<ActivationFunction> clone() const override;
+
   void finalize() override;
 
  private:
@@ -61,6 +61,21 @@ void Block::update_solution(
 
 void Block::post_solve(Eigen::Matrix<double, Eigen::Dynamic, 1>& y) {}
 
+bool Block::modifies_solution() const { return false; }
+
+int Block::get_num_switching_functions() const { return 0; }
+
+void Block::get_switching_functions(
+    const Eigen::Matrix<double, Eigen::Dynamic, 1>& y,
+    std::vector<double>& values) const {}
+
+void Block::update_discrete_state(
+    const Eigen::Matrix<double, Eigen::Dynamic, 1>& y) {}
+
+bool Block::is_linear_time_invariant() const { return false; }
+
+bool Block::is_steady_time_invariant() const { return true; }
+
 void Block::update_gradient(Eigen::SparseMatrix<double>& jacobian,
                             Eigen::Matrix<double, Eigen::Dynamic, 1>& residual,
                             Eigen::Matrix<double, Eigen::Dynamic, 1>& alpha,
@@ -112,11 +112,6 @@ class Block {
    */
   ~Block();
 
-  /**
-   * @brief Copy the Block object
-   *
-   */
-  Block(const Block&) = delete;
   /**
    * @brief Global IDs for the block parameters.
    *
@@ -251,6 +246,79 @@ class Block {
    */
   virtual void post_solve(Eigen::Matrix<double, Eigen::Dynamic, 1>& y);
 
+  /**
+   * @brief Check if the element modifies the solution in post_solve
+   *
+   * The modified iterates depend on the path of the non-linear iterations,
+   * so the converged solution of such elements depends on the predictor and
+   * on the reuse of Jacobian factorizations.
+   *
+   * @return bool True if post_solve modifies the solution
+   */
+  virtual bool modifies_solution() const;
+
+  /**
+   * @brief Get the number of switching functions of the element
+   *
+   * Elements that switch between discrete states in update_solution (e.g.
+   * open and closed valves) have one switching function per switch (see
+   * get_switching_functions).
+   *
+   * @return int Number of switching functions
+   */
+  virtual int get_num_switching_functions() const;
+
+  /**
+   * @brief Evaluate the switching functions of the element
+   *
+   * A switching function is positive if and only if its switch should be in
+   * the first of its two discrete states for the given solution (e.g. an
+   * open valve). A change of its sign within a time step is an event. The
+   * values are appended to the given vector.
+   *
+   * @param y Current solution
+   * @param values Values of the switching functions
+   */
+  virtual void get_switching_functions(
+      const Eigen::Matrix<double, Eigen::Dynamic, 1>& y,
+      std::vector<double>& values) const;
+
+  /**
+   * @brief Set the discrete states of the element from the solution
+   *
+   * While Model::freeze_discrete_states is set, update_solution keeps the
+   * discrete states set here.
+   *
+   * @param y Current solution
+   */
+  virtual void update_discrete_state(
+      const Eigen::Matrix<double, Eigen::Dynamic, 1>& y);
+
+  /**
+   * @brief Check if the element is linear and time-invariant
+   *
+   * An element is linear and time-invariant if its contributions to the
+   * system matrices E and F do not change in time and its solution-dependent
+   * contributions (C, dC/dy, dC/dydot) are zero. Its contributions to the
+   * vector C may still depend on time. Elements are conservatively assumed to
+   * be non-linear unless they override this method.
+   *
+   * @return bool True if the element is linear and time-invariant
+   */
+  virtual bool is_linear_time_invariant() const;
+
+  /**
+   * @brief Check if the element is time-invariant in its steady behavior
+   *
+   * The steady behavior (see Model::to_steady) replaces the time-dependent
+   * parameters with their mean values. Elements whose contributions still
+   * depend on time (e.g. chambers with an activation function) don't have a
+   * steady state.
+   *
+   * @return bool True if the steady element is time-invariant
+   */
+  virtual bool is_steady_time_invariant() const;
+
   /**
    * @brief Set the gradient of the block contributions with respect to the
    * parameters
@@ -285,6 +353,37 @@ class Block {
    */
   virtual TripletsContributions get_num_triplets();
 
+  /**
+   * @brief Matrix entries that the element writes in update_time and
+   * update_solution
+   *
+   * Each entry is a pair of local indices into \ref global_eqn_ids and
+   * \ref global_var_ids. The storage indices of these entries in the system
+   * matrices are looked up once in SparseSystem::reserve. The element can then
+   * write its contributions directly into the value arrays of the system
+   * matrices (see get_slots) instead of searching for them with `coeffRef`.
+   */
+  std::vector<std::pair<int, int>> slot_entries;
+
+  /**
+   * @brief Offset of the element entries in SparseSystem::slots
+   */
+  int slot_offset = 0;
+
+  /**
+   * @brief Get the storage indices of the matrix entries of the element
+   *
+   * The storage indices are in the same order as \ref slot_entries and are
+   * valid for the value arrays of all system matrices (F, E, dC/dy, dC/dydot)
+   * since they share one sparsity pattern.
+   *
+   * @param system System in which the entries are stored
+   * @return const int* Storage indices of the element entries
+   */
+  const int* get_slots(const SparseSystem& system) const {
+    return system.slots.data() + slot_offset;
+  }
+
   /**
    * @brief Set activation function (for chamber blocks that use one).
    *
@@ -297,6 +396,22 @@ class Block {
   virtual void set_activation_function(std::unique_ptr<ActivationFunction> af) {
     (void)af;  // Included to avoid unused parameter warning
   }
+
+  /**
+   * @brief Get activation function (for chamber blocks that use one).
+   *
+   * @return ActivationFunction* The activation function (nullptr if the block
+   * has none)
+   */
+  virtual ActivationFunction* get_activation_function() { return nullptr; }
+
+ protected:
+  /**
+   * @brief Copy the Block object (only as part of a block of a concrete type,
+   * see Model::clone)
+   *
+   */
+  Block(const Block&) = default;
 };
 
 #endif
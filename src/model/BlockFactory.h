@@ -17,4 +17,10 @@
  */
 using BlockFactoryFunc = std::function<Block*(int, Model*)>;
 
+/**
+ * @brief General functional for the copying of different types of blocks to
+ * another model
+ */
+using BlockCloneFunc = std::function<Block*(const Block&, Model*)>;
+
 #endif
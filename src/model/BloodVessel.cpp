@@ -3,8 +3,11 @@
 
 #include "BloodVessel.h"
 
+#include "Model.h"
+
 void BloodVessel::setup_dofs(DOFHandler& dofhandler) {
   Block::setup_dofs_(dofhandler, 2, {});
+  slot_entries = {{0, 1}, {1, 1}};
 }
 
 void BloodVessel::update_constant(SparseSystem& system,
@@ -47,12 +50,12 @@ void BloodVessel::update_solution(
   system.C(global_eqn_ids[1]) = stenosis_resistance * 2.0 * capacitance * dq_in;
 
   double sgn_q_in = (0.0 < q_in) - (q_in < 0.0);
-  system.dC_dy.coeffRef(global_eqn_ids[0], global_var_ids[1]) =
-      stenosis_coeff * sgn_q_in * -2.0 * q_in;
-  system.dC_dy.coeffRef(global_eqn_ids[1], global_var_ids[1]) =
+  auto slots = get_slots(system);
+  system.dC_dy.valuePtr()[slots[0]] = stenosis_coeff * sgn_q_in * -2.0 * q_in;
+  system.dC_dy.valuePtr()[slots[1]] =
       stenosis_coeff * sgn_q_in * 2.0 * capacitance * dq_in;
 
-  system.dC_dydot.coeffRef(global_eqn_ids[1], global_var_ids[1]) =
+  system.dC_dydot.valuePtr()[slots[1]] =
       stenosis_resistance * 2.0 * capacitance;
 }
 
@@ -102,3 +105,70 @@ void BloodVessel::update_gradient(
       y1 - y3 - capacitance * dy0 +
       capacitance * (resistance + 2.0 * stenosis_resistance) * dy1;
 }
+
+bool BloodVessel::is_linear_time_invariant() const {
+  int param_id = global_param_ids[ParamId::STENOSIS_COEFFICIENT];
+  return model->is_constant_parameter(param_id) &&
+         (model->get_parameter_value(param_id) == 0.0);
+}
+
+void BloodVesselBatch::setup(const std::vector<BloodVessel*>& vessels) {
+  int n = vessels.size();
+  capacitance_ids.resize(n);
+  stenosis_coeff_ids.resize(n);
+  q_in_ids.resize(n);
+  eqn_ids_0.resize(n);
+  eqn_ids_1.resize(n);
+  slot_offsets.resize(n);
+  for (int i = 0; i < n; i++) {
+    auto vessel = vessels[i];
+    capacitance_ids[i] =
+        vessel->global_param_ids[BloodVessel::ParamId::CAPACITANCE];
+    stenosis_coeff_ids[i] =
+        vessel->global_param_ids[BloodVessel::ParamId::STENOSIS_COEFFICIENT];
+    q_in_ids[i] = vessel->global_var_ids[1];
+    eqn_ids_0[i] = vessel->global_eqn_ids[0];
+    eqn_ids_1[i] = vessel->global_eqn_ids[1];
+    slot_offsets[i] = vessel->slot_offset;
+  }
+
+  for (auto array : {&capacitance, &stenosis_coeff, &q_in, &dq_in, &c_0, &c_1,
+                     &dc_dy_0, &dc_dy_1, &dc_dydot_1}) {
+    array->resize(n);
+  }
+}
+
+void BloodVesselBatch::update_solution(
+    SparseSystem& system, const std::vector<double>& parameters,
+    const Eigen::Matrix<double, Eigen::Dynamic, 1>& y,
+    const Eigen::Matrix<double, Eigen::Dynamic, 1>& dy) {
+  int n = q_in_ids.size();
+
+  // Gather parameters and solution
+  for (int i = 0; i < n; i++) {
+    capacitance[i] = parameters[capacitance_ids[i]];
+    stenosis_coeff[i] = parameters[stenosis_coeff_ids[i]];
+    q_in[i] = y[q_in_ids[i]];
+    dq_in[i] = dy[q_in_ids[i]];
+  }
+
+  // Compute element contributions (same operations and order of evaluation
+  // as in BloodVessel::update_solution)
+  c_0 = stenosis_coeff * q_in.abs() * -q_in;
+  c_1 = stenosis_coeff * q_in.abs() * 2.0 * capacitance * dq_in;
+  dc_dy_0 = stenosis_coeff * q_in.sign() * -2.0 * q_in;
+  dc_dy_1 = stenosis_coeff * q_in.sign() * 2.0 * capacitance * dq_in;
+  dc_dydot_1 = stenosis_coeff * q_in.abs() * 2.0 * capacitance;
+
+  // Scatter element contributions
+  const int* slots = system.slots.data();
+  double* dc_dy = system.dC_dy.valuePtr();
+  double* dc_dydot = system.dC_dydot.valuePtr();
+  for (int i = 0; i < n; i++) {
+    system.C(eqn_ids_0[i]) = c_0[i];
+    system.C(eqn_ids_1[i]) = c_1[i];
+    dc_dy[slots[slot_offsets[i]]] = dc_dy_0[i];
+    dc_dy[slots[slot_offsets[i] + 1]] = dc_dy_1[i];
+    dc_dydot[slots[slot_offsets[i] + 1]] = dc_dydot_1[i];
+  }
+}
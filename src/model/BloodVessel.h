@@ -9,6 +9,9 @@
 
 #include <math.h>
 
+#include <Eigen/Core>
+#include <vector>
+
 #include "Block.h"
 #include "SparseSystem.h"
 
@@ -209,6 +212,13 @@ class BloodVessel : public Block {
                        Eigen::Matrix<double, Eigen::Dynamic, 1>& alpha,
                        std::vector<double>& y, std::vector<double>& dy);
 
+  /**
+   * @brief Check if the element is linear and time-invariant
+   *
+   * @return bool True if the element is linear and time-invariant
+   */
+  bool is_linear_time_invariant() const;
+
   /**
    * @brief Number of triplets of element
    *
@@ -218,4 +228,73 @@ class BloodVessel : public Block {
   TripletsContributions num_triplets{5, 3, 2};
 };
 
+/**
+ * @brief Batched evaluation of the solution-dependent contributions of many
+ * BloodVessel blocks
+ *
+ * The global indices of all vessels are stored once as a struct of arrays.
+ * In each call, the capacitance, stenosis coefficient, inlet flow and inlet
+ * flow derivative of all vessels are gathered into contiguous arrays, the
+ * stenosis contributions are computed with vectorized array expressions and
+ * the results are scattered into the system. The arithmetic is the same as
+ * in BloodVessel::update_solution, so the results are bit-identical.
+ *
+ * The gather and scatter cost more than the vectorized arithmetic saves
+ * unless the model has thousands of vessels (see benchmark_blood_vessel), so
+ * Model only uses the batch from min_num_vessels vessels on.
+ */
+class BloodVesselBatch {
+ public:
+  /**
+   * @brief Minimum number of vessels for which the batched evaluation is
+   * faster than the per-block evaluation
+   */
+  static constexpr size_t min_num_vessels = 4000;
+
+  /**
+   * @brief Set up the indices of the vessels
+   *
+   * Must be called after the degrees-of-freedom of the vessels are set up.
+   *
+   * @param vessels The vessels to evaluate
+   */
+  void setup(const std::vector<BloodVessel*>& vessels);
+
+  /**
+   * @brief Update the solution-dependent contributions of all vessels in a
+   * sparse system
+   *
+   * @param system System to update contributions at
+   * @param parameters Parameters of the model
+   * @param y Current solution
+   * @param dy Current derivate of the solution
+   */
+  void update_solution(SparseSystem& system,
+                       const std::vector<double>& parameters,
+                       const Eigen::Matrix<double, Eigen::Dynamic, 1>& y,
+                       const Eigen::Matrix<double, Eigen::Dynamic, 1>& dy);
+
+ private:
+  // Global indices of the vessels
+  std::vector<int> capacitance_ids;
+  std::vector<int> stenosis_coeff_ids;
+  std::vector<int> q_in_ids;
+  std::vector<int> eqn_ids_0;
+  std::vector<int> eqn_ids_1;
+  std::vector<int> slot_offsets;
+
+  // Gathered inputs
+  Eigen::ArrayXd capacitance;
+  Eigen::ArrayXd stenosis_coeff;
+  Eigen::ArrayXd q_in;
+  Eigen::ArrayXd dq_in;
+
+  // Contributions to C, dC/dy and dC/dydot
+  Eigen::ArrayXd c_0;
+  Eigen::ArrayXd c_1;
+  Eigen::ArrayXd dc_dy_0;
+  Eigen::ArrayXd dc_dy_1;
+  Eigen::ArrayXd dc_dydot_1;
+};
+
 #endif  // SVZERODSOLVER_MODEL_BLOODVESSEL_HPP_
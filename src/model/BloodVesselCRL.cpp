@@ -3,8 +3,11 @@
 
 #include "BloodVesselCRL.h"
 
+#include "Model.h"
+
 void BloodVesselCRL::setup_dofs(DOFHandler& dofhandler) {
   Block::setup_dofs_(dofhandler, 2, {});
+  slot_entries = {{0, 1}};
 }
 
 void BloodVesselCRL::update_constant(SparseSystem& system,
@@ -44,7 +47,7 @@ void BloodVesselCRL::update_solution(
   system.C(global_eqn_ids[0]) = stenosis_resistance * -q_out;
 
   double sgn_q_out = (0.0 < q_out) - (q_out < 0.0);
-  system.dC_dy.coeffRef(global_eqn_ids[0], global_var_ids[1]) =
+  system.dC_dy.valuePtr()[get_slots(system)[0]] =
       stenosis_coeff * sgn_q_out * -2.0 * q_out;
 }
 
@@ -85,3 +88,9 @@ void BloodVesselCRL::update_gradient(
       y0 - (resistance + stenosis_resistance) * y3 - y2 - inductance * dy3;
   residual(global_eqn_ids[1]) = y1 - y3 - capacitance * dy0;
 }
+
+bool BloodVesselCRL::is_linear_time_invariant() const {
+  int param_id = global_param_ids[ParamId::STENOSIS_COEFFICIENT];
+  return model->is_constant_parameter(param_id) &&
+         (model->get_parameter_value(param_id) == 0.0);
+}
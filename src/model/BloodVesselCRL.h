@@ -188,6 +188,13 @@ class BloodVesselCRL : public Block {
                        Eigen::Matrix<double, Eigen::Dynamic, 1>& alpha,
                        std::vector<double>& y, std::vector<double>& dy);
 
+  /**
+   * @brief Check if the element is linear and time-invariant
+   *
+   * @return bool True if the element is linear and time-invariant
+   */
+  bool is_linear_time_invariant() const;
+
   /**
    * @brief Number of triplets of element
    *
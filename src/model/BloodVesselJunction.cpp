@@ -3,6 +3,8 @@
 
 #include "BloodVesselJunction.h"
 
+#include "Model.h"
+
 void BloodVesselJunction::setup_dofs(DOFHandler& dofhandler) {
   if (inlet_nodes.size() != 1) {
     throw std::runtime_error(
@@ -14,6 +16,9 @@ void BloodVesselJunction::setup_dofs(DOFHandler& dofhandler) {
   num_triplets.F = 1 + 4 * num_outlets;
   num_triplets.E = 3 * num_outlets;
   num_triplets.D = 2 * num_outlets;
+  for (int i = 0; i < num_outlets; i++) {
+    slot_entries.push_back({i + 1, 3 + 2 * i});
+  }
 }
 
 void BloodVesselJunction::update_constant(SparseSystem& system,
@@ -39,6 +44,7 @@ void BloodVesselJunction::update_solution(
     SparseSystem& system, std::vector<double>& parameters,
     const Eigen::Matrix<double, Eigen::Dynamic, 1>& y,
     const Eigen::Matrix<double, Eigen::Dynamic, 1>& dy) {
+  auto slots = get_slots(system);
   for (size_t i = 0; i < num_outlets; i++) {
     // Get parameters
     auto stenosis_coeff = parameters[global_param_ids[2 * num_outlets + i]];
@@ -47,8 +53,7 @@ void BloodVesselJunction::update_solution(
 
     // Mass conservation
     system.C(global_eqn_ids[i + 1]) = -stenosis_resistance * q_out;
-    system.dC_dy.coeffRef(global_eqn_ids[i + 1], global_var_ids[3 + 2 * i]) =
-        -2.0 * stenosis_resistance;
+    system.dC_dy.valuePtr()[slots[i]] = -2.0 * stenosis_resistance;
   }
 }
 
@@ -94,3 +99,14 @@ void BloodVesselJunction::update_gradient(
         inductance * dq_out;
   }
 }
+
+bool BloodVesselJunction::is_linear_time_invariant() const {
+  for (size_t i = 0; i < num_outlets; i++) {
+    int param_id = global_param_ids[2 * num_outlets + i];
+    if (!model->is_constant_parameter(param_id) ||
+        (model->get_parameter_value(param_id) != 0.0)) {
+      return false;
+    }
+  }
+  return true;
+}
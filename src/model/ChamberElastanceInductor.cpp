@@ -5,6 +5,7 @@
 void ChamberElastanceInductor::setup_dofs(DOFHandler& dofhandler) {
   // Internal variable is chamber volume
   Block::setup_dofs_(dofhandler, 3, {"Vc"});
+  slot_entries = {{0, 4}};
 }
 
 void ChamberElastanceInductor::update_constant(
@@ -30,7 +31,7 @@ void ChamberElastanceInductor::update_time(SparseSystem& system,
   get_elastance_values(parameters);
 
   // Eq 0: P_in - E(t)(Vc - Vrest) = P_in - E(t)*Vc + E(t)*Vrest = 0
-  system.F.coeffRef(global_eqn_ids[0], global_var_ids[4]) = -1 * Elas;
+  system.F.valuePtr()[get_slots(system)[0]] = -1 * Elas;
   system.C.coeffRef(global_eqn_ids[0]) = Elas * Vrest;
 }
 
@@ -42,7 +43,8 @@ void ChamberElastanceInductor::get_elastance_values(
   double Vrs = parameters[global_param_ids[ParamId::VRS]];
 
   // Compute activation using the activation function
-  double act = activation_func_->compute(model->time);
+  double act =
+      activation_func_->get(model->time, model->get_time_table_index());
 
   Vrest = (1.0 - act) * (Vrd - Vrs) + Vrs;
   Elas = (Emax - Emin) * act + Emin;
@@ -52,3 +54,7 @@ void ChamberElastanceInductor::set_activation_function(
     std::unique_ptr<ActivationFunction> af) {
   activation_func_ = std::move(af);
 }
+
+bool ChamberElastanceInductor::is_steady_time_invariant() const {
+  return false;
+}
@@ -160,6 +160,21 @@ class ChamberElastanceInductor : public Block {
                {"Vrs", InputParameter()},
                {"Impedance", InputParameter()}}) {}
 
+  /**
+   * @brief Copy a ChamberElastanceInductor object with a copy of its
+   * activation function (see Model::clone)
+   *
+   * @param other The block to copy
+   */
+  ChamberElastanceInductor(const ChamberElastanceInductor& other)
+      : Block(other),
+        num_triplets(other.num_triplets),
+        Elas(other.Elas),
+        Vrest(other.Vrest),
+        activation_func_(other.activation_func_
+                             ? other.activation_func_->clone()
+                             : nullptr) {}
+
   /**
    * @brief Local IDs of the parameters
    *
@@ -196,6 +211,13 @@ class ChamberElastanceInductor : public Block {
    */
   void update_time(SparseSystem& system, std::vector<double>& parameters);
 
+  /**
+   * @brief Check if the element is time-invariant in its steady behavior
+   *
+   * @return bool False (the activation depends on time)
+   */
+  bool is_steady_time_invariant() const;
+
   /**
    * @brief Number of triplets of element
    *
@@ -217,6 +239,15 @@ class ChamberElastanceInductor : public Block {
    */
   void set_activation_function(std::unique_ptr<ActivationFunction> af) override;
 
+  /**
+   * @brief Get the activation function
+   *
+   * @return ActivationFunction* The activation function
+   */
+  ActivationFunction* get_activation_function() override {
+    return activation_func_.get();
+  }
+
  private:
   /**
    * @brief Update the elastance functions which depend on time
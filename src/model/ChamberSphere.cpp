@@ -8,6 +8,7 @@
 void ChamberSphere::setup_dofs(DOFHandler& dofhandler) {
   Block::setup_dofs_(dofhandler, 7,
                      {"radius", "velo", "stress", "tau", "volume"});
+  slot_entries = {{3, 7}, {0, 2}, {0, 4}, {0, 6}, {1, 4}, {2, 4}, {2, 5}};
 }
 
 void ChamberSphere::update_constant(SparseSystem& system,
@@ -46,7 +47,7 @@ void ChamberSphere::update_time(SparseSystem& system,
                                 std::vector<double>& parameters) {
   // active stress
   get_elastance_values(parameters);
-  system.F.coeffRef(global_eqn_ids[3], global_var_ids[7]) = act;
+  system.F.valuePtr()[get_slots(system)[0]] = act;
 }
 
 void ChamberSphere::update_solution(
@@ -65,16 +66,17 @@ void ChamberSphere::update_solution(
   const double Pout = y[global_var_ids[2]];
   const double radius = y[global_var_ids[4]];
   const double stress = y[global_var_ids[6]];
+  auto slots = get_slots(system);
 
   // balance of momentum
   system.C.coeffRef(global_eqn_ids[0]) =
       (radius + radius0) * (-Pout * (radius + radius0) + stress * thick0) /
       pow(radius0, 2);
-  system.dC_dy.coeffRef(global_eqn_ids[0], global_var_ids[2]) =
+  system.dC_dy.valuePtr()[slots[1]] =
       -pow(radius + radius0, 2) / pow(radius0, 2);
-  system.dC_dy.coeffRef(global_eqn_ids[0], global_var_ids[4]) =
+  system.dC_dy.valuePtr()[slots[2]] =
       (-2 * Pout * (radius + radius0) + stress * thick0) / pow(radius0, 2);
-  system.dC_dy.coeffRef(global_eqn_ids[0], global_var_ids[6]) =
+  system.dC_dy.valuePtr()[slots[3]] =
       thick0 * (radius + radius0) / pow(radius0, 2);
 
   // spherical stress
@@ -85,23 +87,21 @@ void ChamberSphere::update_solution(
            (-pow(radius0, 6) + pow(radius + radius0, 6)) *
            (W1 * pow(radius0, 2) + W2 * pow(radius + radius0, 2))) /
       (pow(radius0, 2) * pow(radius + radius0, 11));
-  system.dC_dy.coeffRef(global_eqn_ids[1], global_var_ids[4]) =
+  system.dC_dy.valuePtr()[slots[4]] =
       24 * W1 * pow(radius0, 6) / pow(radius + radius0, 7) +
       8 * W2 * radius / pow(radius0, 2) +
       16 * W2 * pow(radius0, 4) / pow(radius + radius0, 5) + 8 * W2 / radius0 +
       88 * dradius_dt * eta * pow(radius0, 10) / pow(radius + radius0, 12) +
       4 * dradius_dt * eta / pow(radius0, 2);
-  system.dC_dydot.coeffRef(global_eqn_ids[1], global_var_ids[4]) =
+  system.dC_dydot.valuePtr()[slots[4]] =
       -4 * eta * (2 * pow(radius0, 12) - pow(radius + radius0, 12)) /
       (pow(radius0, 2) * pow(radius + radius0, 11));
 
   // volume change
   system.C.coeffRef(global_eqn_ids[2]) =
       4 * M_PI * velo * pow(radius + radius0, 2);
-  system.dC_dy.coeffRef(global_eqn_ids[2], global_var_ids[4]) =
-      8 * M_PI * velo * (radius + radius0);
-  system.dC_dy.coeffRef(global_eqn_ids[2], global_var_ids[5]) =
-      4 * M_PI * pow(radius + radius0, 2);
+  system.dC_dy.valuePtr()[slots[5]] = 8 * M_PI * velo * (radius + radius0);
+  system.dC_dy.valuePtr()[slots[6]] = 4 * M_PI * pow(radius + radius0, 2);
 
   // active stress
   system.C.coeffRef(global_eqn_ids[3]) = -act_plus * sigma_max;
@@ -130,4 +130,6 @@ void ChamberSphere::get_elastance_values(std::vector<double>& parameters) {
 
   act = std::abs(act_t);
   act_plus = std::max(act_t, 0.0);
-}
\ No newline at end of file
+}
+
+bool ChamberSphere::is_steady_time_invariant() const { return false; }
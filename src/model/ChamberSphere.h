@@ -202,6 +202,13 @@ class ChamberSphere : public Block {
    */
   void update_time(SparseSystem& system, std::vector<double>& parameters);
 
+  /**
+   * @brief Check if the element is time-invariant in its steady behavior
+   *
+   * @return bool False (the activation depends on time)
+   */
+  bool is_steady_time_invariant() const;
+
   /**
    * @brief Update the solution-dependent contributions of the element in a
    * sparse system
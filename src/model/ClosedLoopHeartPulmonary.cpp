@@ -2,12 +2,19 @@
 // University of California, and others. SPDX-License-Identifier: BSD-3-Clause
 #include "ClosedLoopHeartPulmonary.h"
 
+#include <algorithm>
+
 #include "Model.h"
 
 void ClosedLoopHeartPulmonary::setup_dofs(DOFHandler& dofhandler) {
   Block::setup_dofs_(dofhandler, 14,
                      {"V_RA", "Q_RA", "P_RV", "V_RV", "Q_RV", "P_pul", "P_LA",
                       "V_LA", "Q_LA", "P_LV", "V_LV", "Q_LV"});
+  // Elastance entries (update_time and update_solution) followed by the valve
+  // entries (update_solution)
+  slot_entries = {{0, 4},   {4, 7},   {8, 11},  {11, 14}, {1, 15}, {7, 8},
+                  {2, 5},   {5, 5},   {5, 8},   {9, 8},   {9, 12}, {12, 12},
+                  {12, 15}, {3, 5},   {6, 8},   {10, 12}, {13, 15}};
 }
 
 void ClosedLoopHeartPulmonary::update_constant(
@@ -78,22 +85,23 @@ void ClosedLoopHeartPulmonary::update_constant(
 void ClosedLoopHeartPulmonary::update_time(SparseSystem& system,
                                            std::vector<double>& parameters) {
   get_activation_and_elastance_functions(parameters);
+  auto slots = get_slots(system);
 
   // DOF 0, Eq 0: Right atrium pressure
-  system.F.coeffRef(global_eqn_ids[0], global_var_ids[4]) =
+  system.F.valuePtr()[slots[0]] =
       -AA * parameters[global_param_ids[ParamId::EMAX_RA]];
 
   // DOF 6, Eq 4: Right ventricle pressure
-  system.F.coeffRef(global_eqn_ids[4], global_var_ids[7]) = -Erv;
+  system.F.valuePtr()[slots[1]] = -Erv;
   system.C(global_eqn_ids[4]) =
       Erv * parameters[global_param_ids[ParamId::VRV_U]];
 
   // DOF 10, Eq 8: Left atrium pressure
-  system.F.coeffRef(global_eqn_ids[8], global_var_ids[11]) =
+  system.F.valuePtr()[slots[2]] =
       -AA * parameters[global_param_ids[ParamId::EMAX_LA]];
 
   // DOF 13, Eq 11: Left ventricle pressure
-  system.F.coeffRef(global_eqn_ids[11], global_var_ids[14]) = -Elv;
+  system.F.valuePtr()[slots[3]] = -Elv;
   system.C(global_eqn_ids[11]) =
       Elv * parameters[global_param_ids[ParamId::VLV_U]];
 }
@@ -103,7 +111,10 @@ void ClosedLoopHeartPulmonary::update_solution(
     const Eigen::Matrix<double, Eigen::Dynamic, 1>& y,
     const Eigen::Matrix<double, Eigen::Dynamic, 1>& dy) {
   get_psi_ra_la(parameters, y);
-  get_valve_positions(y);
+  if (!model->freeze_discrete_states) {
+    get_valve_positions(y);
+  }
+  auto slots = get_slots(system);
 
   // Technically, F matrix and C vector neither depend on time nor solution
   // However, we treat F here as constant (despite the solution-dependent
@@ -119,52 +130,50 @@ void ClosedLoopHeartPulmonary::update_solution(
       AA * parameters[global_param_ids[ParamId::EMAX_RA]] *
           parameters[global_param_ids[ParamId::VASO_RA]] +
       psi_ra * (AA - 1.0);
-  system.dC_dy.coeffRef(global_eqn_ids[0], global_var_ids[4]) =
-      psi_ra_derivative * (AA - 1.0);
+  system.dC_dy.valuePtr()[slots[0]] = psi_ra_derivative * (AA - 1.0);
 
   // DOF 10, Eq 8: Left atrium pressure
   system.C(global_eqn_ids[8]) =
       AA * parameters[global_param_ids[ParamId::EMAX_LA]] *
           parameters[global_param_ids[ParamId::VASO_LA]] +
       psi_la * (AA - 1.0);
-  system.dC_dy.coeffRef(global_eqn_ids[8], global_var_ids[11]) =
-      psi_la_derivative * (AA - 1.0);
+  system.dC_dy.valuePtr()[slots[2]] = psi_la_derivative * (AA - 1.0);
 
   // DOF 2, Eq 1: Aortic pressure
-  system.F.coeffRef(global_eqn_ids[1], global_var_ids[15]) = -valves[15];
+  system.F.valuePtr()[slots[4]] = -valves[15];
 
   // DOF 9, Eq 7: Pulmonary pressure
-  system.F.coeffRef(global_eqn_ids[7], global_var_ids[8]) = -valves[8];
+  system.F.valuePtr()[slots[5]] = -valves[8];
 
   // DOF 4, Eq 2: Right atrium volume
-  system.F.coeffRef(global_eqn_ids[2], global_var_ids[5]) = valves[5];
+  system.F.valuePtr()[slots[6]] = valves[5];
 
   // DOF 7, Eq 5: Right ventricle volume
-  system.F.coeffRef(global_eqn_ids[5], global_var_ids[5]) = -valves[5];
-  system.F.coeffRef(global_eqn_ids[5], global_var_ids[8]) = valves[8];
+  system.F.valuePtr()[slots[7]] = -valves[5];
+  system.F.valuePtr()[slots[8]] = valves[8];
 
   // DOF 11, Eq 9: Left atrium volume
-  system.F.coeffRef(global_eqn_ids[9], global_var_ids[8]) = -valves[8];
-  system.F.coeffRef(global_eqn_ids[9], global_var_ids[12]) = valves[12];
+  system.F.valuePtr()[slots[9]] = -valves[8];
+  system.F.valuePtr()[slots[10]] = valves[12];
 
   // DOF 14, Eq 12: Left ventricle volume
-  system.F.coeffRef(global_eqn_ids[12], global_var_ids[12]) = -valves[12];
-  system.F.coeffRef(global_eqn_ids[12], global_var_ids[15]) = valves[15];
+  system.F.valuePtr()[slots[11]] = -valves[12];
+  system.F.valuePtr()[slots[12]] = valves[15];
 
   // DOF 5, Eq 3: Right atrium outflow
-  system.F.coeffRef(global_eqn_ids[3], global_var_ids[5]) =
+  system.F.valuePtr()[slots[13]] =
       parameters[global_param_ids[ParamId::RRA_V]] * valves[5];
 
   // DOF 8, Eq 6: Right ventricle outflow
-  system.F.coeffRef(global_eqn_ids[6], global_var_ids[8]) =
+  system.F.valuePtr()[slots[14]] =
       parameters[global_param_ids[ParamId::RRV_A]] * valves[8];
 
   // DOF 12, Eq 10: Left atrium outflow
-  system.F.coeffRef(global_eqn_ids[10], global_var_ids[12]) =
+  system.F.valuePtr()[slots[15]] =
       parameters[global_param_ids[ParamId::RLA_V]] * valves[12];
 
   // DOF 15, Eq 13: Left ventricle outflow
-  system.F.coeffRef(global_eqn_ids[13], global_var_ids[15]) =
+  system.F.valuePtr()[slots[16]] =
       parameters[global_param_ids[ParamId::RLV_AO]] * valves[15];
 }
 
@@ -244,38 +253,24 @@ void ClosedLoopHeartPulmonary::get_psi_ra_la(
       parameters[global_param_ids[ParamId::KXV_LA]];
 }
 
+// Heart valves as indices of the upstream pressure, downstream pressure, and
+// flow in global_var_ids (the valve position is stored at the flow index)
+static constexpr int heart_valves[4][3] = {
+    {0, 6, 5},     // RA to RV
+    {6, 9, 8},     // RV to pulmonary
+    {10, 13, 12},  // LA to LV
+    {13, 2, 15}};  // LV to aorta
+
 void ClosedLoopHeartPulmonary::get_valve_positions(
     const Eigen::Matrix<double, Eigen::Dynamic, 1>& y) {
   std::fill(valves, valves + 16, 1.0);
 
-  // RA to RV
-  auto pressure_ra = y[global_var_ids[0]];
-  auto pressure_rv = y[global_var_ids[6]];
-  auto outflow_ra = y[global_var_ids[5]];
-  if ((pressure_ra <= pressure_rv) && (outflow_ra <= 0.0)) {
-    valves[5] = 0.0;
-  }
-
-  // RV to pulmonary
-  auto pressure_pulmonary = y[global_var_ids[9]];
-  auto outflow_rv = y[global_var_ids[8]];
-  if ((pressure_rv <= pressure_pulmonary) && (outflow_rv <= 0.0)) {
-    valves[8] = 0.0;
-  }
-
-  // LA to LV
-  auto pressure_la = y[global_var_ids[10]];
-  auto pressure_lv = y[global_var_ids[13]];
-  auto outflow_la = y[global_var_ids[12]];
-  if ((pressure_la <= pressure_lv) && (outflow_la <= 0.0)) {
-    valves[12] = 0.0;
-  }
-
-  // LV to aorta
-  auto pressure_aorta = y[global_var_ids[2]];
-  auto outflow_lv = y[global_var_ids[15]];
-  if ((pressure_lv <= pressure_aorta) && (outflow_lv <= 0.0)) {
-    valves[15] = 0.0;
+  // A valve is closed if the pressure and the flow don't push forward
+  for (const auto& [upstream, downstream, flow] : heart_valves) {
+    if ((y[global_var_ids[upstream]] <= y[global_var_ids[downstream]]) &&
+        (y[global_var_ids[flow]] <= 0.0)) {
+      valves[flow] = 0.0;
+    }
   }
 }
 
@@ -284,3 +279,32 @@ void ClosedLoopHeartPulmonary::post_solve(
   for (size_t i = 0; i < 16; i++)
     if (valves[i] < 0.5) y[global_var_ids[i]] = 0.0;
 }
+
+bool ClosedLoopHeartPulmonary::modifies_solution() const { return true; }
+
+int ClosedLoopHeartPulmonary::get_num_switching_functions() const {
+  return 4;
+}
+
+void ClosedLoopHeartPulmonary::get_switching_functions(
+    const Eigen::Matrix<double, Eigen::Dynamic, 1>& y,
+    std::vector<double>& values) const {
+  for (const auto& [upstream, downstream, flow] : heart_valves) {
+    double pressure_difference =
+        y[global_var_ids[upstream]] - y[global_var_ids[downstream]];
+    if (valves[flow] > 0.5) {
+      values.push_back(std::max(pressure_difference, y[global_var_ids[flow]]));
+    } else {
+      values.push_back(pressure_difference);
+    }
+  }
+}
+
+void ClosedLoopHeartPulmonary::update_discrete_state(
+    const Eigen::Matrix<double, Eigen::Dynamic, 1>& y) {
+  get_valve_positions(y);
+}
+
+bool ClosedLoopHeartPulmonary::is_steady_time_invariant() const {
+  return false;
+}
@@ -215,6 +215,13 @@ class ClosedLoopHeartPulmonary : public Block {
    */
   void update_time(SparseSystem& system, std::vector<double>& parameters);
 
+  /**
+   * @brief Check if the element is time-invariant in its steady behavior
+   *
+   * @return bool False (the activation depends on time)
+   */
+  bool is_steady_time_invariant() const;
+
   /**
    * @brief Update the solution-dependent contributions of the element in a
    * sparse system
@@ -235,6 +242,42 @@ class ClosedLoopHeartPulmonary : public Block {
    */
   void post_solve(Eigen::Matrix<double, Eigen::Dynamic, 1>& y);
 
+  /**
+   * @brief Check if the element modifies the solution in post_solve
+   *
+   * @return bool True (the flows through closed valves are set to zero)
+   */
+  bool modifies_solution() const;
+
+  /**
+   * @brief Get the number of switching functions of the element
+   *
+   * @return int Number of switching functions (one per heart valve)
+   */
+  int get_num_switching_functions() const;
+
+  /**
+   * @brief Evaluate the switching functions of the element
+   *
+   * The switching function of a closed valve is the pressure difference
+   * across it. The one of an open valve is the maximum of the pressure
+   * difference and the flow through it.
+   *
+   * @param y Current solution
+   * @param values Values of the switching functions
+   */
+  void get_switching_functions(
+      const Eigen::Matrix<double, Eigen::Dynamic, 1>& y,
+      std::vector<double>& values) const;
+
+  /**
+   * @brief Set the valve positions from the solution
+   *
+   * @param y Current solution
+   */
+  void update_discrete_state(
+      const Eigen::Matrix<double, Eigen::Dynamic, 1>& y);
+
   /**
    * @brief Number of triplets of element
    *
@@ -15,3 +15,5 @@ void FlowReferenceBC::update_time(SparseSystem& system,
                                   std::vector<double>& parameters) {
   system.C(global_eqn_ids[0]) = -parameters[global_param_ids[0]];
 }
+
+bool FlowReferenceBC::is_linear_time_invariant() const { return true; }
@@ -116,6 +116,13 @@ class FlowReferenceBC : public Block {
    */
   void update_time(SparseSystem& system, std::vector<double>& parameters);
 
+  /**
+   * @brief Check if the element is linear and time-invariant
+   *
+   * @return bool True if the element is linear and time-invariant
+   */
+  bool is_linear_time_invariant() const;
+
   /**
    * @brief Number of triplets of element
    *
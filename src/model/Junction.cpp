@@ -42,3 +42,5 @@ void Junction::update_gradient(
 
   residual(global_eqn_ids[1]) = y[global_var_ids[1]] - y[global_var_ids[3]];
 }
+
+bool Junction::is_linear_time_invariant() const { return true; }
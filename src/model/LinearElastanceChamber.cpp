@@ -6,6 +6,7 @@
 void LinearElastanceChamber::setup_dofs(DOFHandler& dofhandler) {
   // Internal variable is chamber volume
   Block::setup_dofs_(dofhandler, 3, {"Vc"});
+  slot_entries = {{0, 4}};
 }
 
 void LinearElastanceChamber::update_constant(SparseSystem& system,
@@ -28,7 +29,7 @@ void LinearElastanceChamber::update_time(SparseSystem& system,
   get_elastance_values(parameters);
 
   // Eq 0: P_in - E(t)(Vc - Vrest) = P_in - E(t)*Vc + E(t)*Vrest = 0
-  system.F.coeffRef(global_eqn_ids[0], global_var_ids[4]) = -Elas;
+  system.F.valuePtr()[get_slots(system)[0]] = -Elas;
   system.C.coeffRef(global_eqn_ids[0]) =
       Elas * parameters[global_param_ids[ParamId::VREST]];
 }
@@ -39,7 +40,8 @@ void LinearElastanceChamber::get_elastance_values(
   double Epass = parameters[global_param_ids[ParamId::EPASS]];
 
   // Compute activation using the activation function
-  double phi = activation_func_->compute(model->time);
+  double phi =
+      activation_func_->get(model->time, model->get_time_table_index());
 
   Elas = Epass + Emax * phi;
 }
@@ -48,3 +50,5 @@ void LinearElastanceChamber::set_activation_function(
     std::unique_ptr<ActivationFunction> af) {
   activation_func_ = std::move(af);
 }
+
+bool LinearElastanceChamber::is_steady_time_invariant() const { return false; }
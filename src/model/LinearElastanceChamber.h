@@ -133,6 +133,20 @@ class LinearElastanceChamber : public Block {
                {"Epass", InputParameter()},
                {"Vrest", InputParameter()}}) {}
 
+  /**
+   * @brief Copy a LinearElastanceChamber object with a copy of its activation
+   * function (see Model::clone)
+   *
+   * @param other The block to copy
+   */
+  LinearElastanceChamber(const LinearElastanceChamber& other)
+      : Block(other),
+        num_triplets(other.num_triplets),
+        Elas(other.Elas),
+        activation_func_(other.activation_func_
+                             ? other.activation_func_->clone()
+                             : nullptr) {}
+
   /**
    * @brief Local IDs of the parameters
    *
@@ -169,6 +183,13 @@ class LinearElastanceChamber : public Block {
    */
   void update_time(SparseSystem& system, std::vector<double>& parameters);
 
+  /**
+   * @brief Check if the element is time-invariant in its steady behavior
+   *
+   * @return bool False (the activation depends on time)
+   */
+  bool is_steady_time_invariant() const;
+
   /**
    * @brief Number of triplets of element
    *
@@ -189,6 +210,15 @@ class LinearElastanceChamber : public Block {
    */
   void set_activation_function(std::unique_ptr<ActivationFunction> af) override;
 
+  /**
+   * @brief Get the activation function
+   *
+   * @return ActivationFunction* The activation function
+   */
+  ActivationFunction* get_activation_function() override {
+    return activation_func_.get();
+  }
+
  private:
   /**
    * @brief Update the elastance functions which depend on time
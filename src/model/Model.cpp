@@ -2,6 +2,30 @@
 // University of California, and others. SPDX-License-Identifier: BSD-3-Clause
 #include "Model.h"
 
+#include <cmath>
+#include <type_traits>
+
+// Check if a block type overrides a function of Block. Blocks of types that
+// don't override a function are skipped when the function is called for all
+// blocks.
+template <typename T>
+constexpr bool overrides_update_time =
+    !std::is_same_v<decltype(&T::update_time), decltype(&Block::update_time)>;
+
+template <typename T>
+constexpr bool overrides_update_solution =
+    !std::is_same_v<decltype(&T::update_solution),
+                    decltype(&Block::update_solution)>;
+
+template <typename T>
+constexpr bool overrides_post_solve =
+    !std::is_same_v<decltype(&T::post_solve), decltype(&Block::post_solve)>;
+
+// Concrete block type of a group in Model::block_groups
+template <typename Group>
+using group_block_t =
+    std::remove_pointer_t<typename std::decay_t<Group>::value_type>;
+
 template <typename block_type>
 BlockFactoryFunc block_factory() {
   return [](int count, Model* model) -> Block* {
@@ -9,6 +33,15 @@ BlockFactoryFunc block_factory() {
   };
 }
 
+template <typename block_type>
+BlockCloneFunc block_cloner() {
+  return [](const Block& block, Model* model) -> Block* {
+    auto clone = new block_type(static_cast<const block_type&>(block));
+    clone->model = model;
+    return clone;
+  };
+}
+
 Model::Model() {
   // Add all implemented blocks to factory
   block_factory_map = {
@@ -32,10 +65,100 @@ Model::Model() {
       {"BloodVesselCRL", block_factory<BloodVesselCRL>()},
       {"PiecewiseValve", block_factory<PiecewiseValve>()},
       {"LinearElastanceChamber", block_factory<LinearElastanceChamber>()}};
+
+  // Add the copy functions of all implemented blocks
+  block_clone_map = {
+      {BlockType::blood_vessel, block_cloner<BloodVessel>()},
+      {BlockType::chamber_sphere, block_cloner<ChamberSphere>()},
+      {BlockType::blood_vessel_junction, block_cloner<BloodVesselJunction>()},
+      {BlockType::closed_loop_coronary_left_bc,
+       block_cloner<ClosedLoopCoronaryLeftBC>()},
+      {BlockType::closed_loop_coronary_right_bc,
+       block_cloner<ClosedLoopCoronaryRightBC>()},
+      {BlockType::closed_loop_heart_pulmonary,
+       block_cloner<ClosedLoopHeartPulmonary>()},
+      {BlockType::closed_loop_rcr_bc, block_cloner<ClosedLoopRCRBC>()},
+      {BlockType::open_loop_coronary_bc, block_cloner<OpenLoopCoronaryBC>()},
+      {BlockType::flow_bc, block_cloner<FlowReferenceBC>()},
+      {BlockType::junction, block_cloner<Junction>()},
+      {BlockType::pressure_bc, block_cloner<PressureReferenceBC>()},
+      {BlockType::windkessel_bc, block_cloner<WindkesselBC>()},
+      {BlockType::resistance_bc, block_cloner<ResistanceBC>()},
+      {BlockType::resistive_junction, block_cloner<ResistiveJunction>()},
+      {BlockType::valve_tanh, block_cloner<ValveTanh>()},
+      {BlockType::chamber_elastance_inductor,
+       block_cloner<ChamberElastanceInductor>()},
+      {BlockType::blood_vessel_CRL, block_cloner<BloodVesselCRL>()},
+      {BlockType::piecewise_valve, block_cloner<PiecewiseValve>()},
+      {BlockType::linear_elastance_chamber,
+       block_cloner<LinearElastanceChamber>()}};
 }
 
 Model::~Model() {}
 
+std::unique_ptr<Model> Model::clone() const {
+  auto model = std::make_unique<Model>();
+  model->dofhandler = dofhandler;
+  model->cardiac_cycle_period = cardiac_cycle_period;
+  model->time = time;
+  model->freeze_discrete_states = freeze_discrete_states;
+  model->block_count = block_count;
+  model->node_count = node_count;
+  model->parameter_count = parameter_count;
+  model->param_value_cache = param_value_cache;
+  model->block_types = block_types;
+  model->block_names = block_names;
+  model->block_index_map = block_index_map;
+  model->node_names = node_names;
+  model->parameters = parameters;
+  model->parameter_values = parameter_values;
+  model->time_table_step_size = time_table_step_size;
+  model->time_table_offset = time_table_offset;
+  model->has_windkessel_bc = has_windkessel_bc;
+  model->largest_windkessel_time_constant = largest_windkessel_time_constant;
+
+  // Copy the blocks (the nodes are connected again below)
+  std::map<const Block*, Block*> block_map;
+  auto clone_blocks = [&](const std::vector<std::shared_ptr<Block>>& blocks,
+                          std::vector<std::shared_ptr<Block>>& clones) {
+    for (auto& block : blocks) {
+      auto it = block_clone_map.find(block->block_type);
+      if (it == block_clone_map.end()) {
+        throw std::runtime_error("Cannot copy block " +
+                                 get_block_name(block->id));
+      }
+      Block* clone = it->second(*block, model.get());
+      clone->inlet_nodes.clear();
+      clone->outlet_nodes.clear();
+      clones.push_back(std::shared_ptr<Block>(clone));
+      block_map[block.get()] = clone;
+    }
+  };
+  clone_blocks(blocks, model->blocks);
+  clone_blocks(hidden_blocks, model->hidden_blocks);
+
+  // Copy the nodes in the same order, such that the nodes of the blocks are
+  // in the same order as well
+  for (auto& node : nodes) {
+    std::vector<Block*> inlet_eles;
+    std::vector<Block*> outlet_eles;
+    for (auto& block : node->inlet_eles) {
+      inlet_eles.push_back(block_map.at(block));
+    }
+    for (auto& block : node->outlet_eles) {
+      outlet_eles.push_back(block_map.at(block));
+    }
+    auto clone = std::shared_ptr<Node>(
+        new Node(node->id, inlet_eles, outlet_eles, model.get()));
+    clone->flow_dof = node->flow_dof;
+    clone->pres_dof = node->pres_dof;
+    model->nodes.push_back(clone);
+  }
+
+  model->group_blocks();
+  return model;
+}
+
 Block* Model::create_block(const std::string& block_type) {
   // Get block from factory
   auto it = block_factory_map.find(block_type);
@@ -154,7 +277,11 @@ int Model::add_parameter(const std::vector<double>& times,
   return parameter_count++;
 }
 
-Parameter* Model::get_parameter(int param_id) { return &parameters[param_id]; }
+Parameter* Model::get_parameter(int param_id) {
+  // The parameter may be modified
+  time_tables_valid = false;
+  return &parameters[param_id];
+}
 
 double Model::get_parameter_value(int param_id) const {
   return parameter_values[param_id];
@@ -164,19 +291,54 @@ void Model::update_parameter_value(int param_id, double param_value) {
   parameter_values[param_id] = param_value;
 }
 
+void Model::set_parameter_interpolation(InterpolationMethod method,
+                                        int num_resample_points) {
+  for (auto& param : parameters) {
+    param.set_interpolation(method, num_resample_points);
+    parameter_values[param.id] = param.get(time);
+  }
+  time_tables_valid = false;
+}
+
+bool Model::is_constant_parameter(int param_id) const {
+  return parameters[param_id].is_constant;
+}
+
 void Model::finalize() {
   DEBUG_MSG("Setup degrees-of-freedom of nodes");
   for (auto& node : nodes) {
     node->setup_dofs(dofhandler);
   }
   DEBUG_MSG("Setup degrees-of-freedom of blocks");
+  int slot_offset = 0;
   for (auto& block : blocks) {
     block->setup_dofs(dofhandler);
+    block->slot_offset = slot_offset;
+    slot_offset += block->slot_entries.size();
   }
   DEBUG_MSG("Setup model-dependent parameters");
   for (auto& block : blocks) {
     block->setup_model_dependent_params();
   }
+  DEBUG_MSG("Group blocks by type");
+  group_blocks();
+  DEBUG_MSG("Model is linear and time-invariant: "
+            << is_linear_time_invariant());
+}
+
+void Model::group_blocks() {
+  block_groups.clear();
+  ungrouped_blocks.clear();
+  for (auto& block : blocks) {
+    if (!block_groups.add(block.get())) {
+      ungrouped_blocks.push_back(block.get());
+    }
+  }
+  const auto& vessels = block_groups.get<BloodVessel>();
+  use_blood_vessel_batch = vessels.size() >= BloodVesselBatch::min_num_vessels;
+  if (use_blood_vessel_batch) {
+    blood_vessel_batch.setup(vessels);
+  }
 }
 
 int Model::get_num_blocks(bool internal) const {
@@ -190,19 +352,42 @@ int Model::get_num_blocks(bool internal) const {
 }
 
 void Model::update_constant(SparseSystem& system) {
-  for (auto block : blocks) {
+  for (auto& block : blocks) {
     block->update_constant(system, parameter_values);
   }
 }
 
 void Model::update_time(SparseSystem& system, double time) {
   this->time = time;
+  time_table_index = find_time_table_index(time);
 
-  for (auto& param : parameters) {
-    parameter_values[param.id] = param.get(time);
+  if (time_table_index >= 0) {
+    int num_params = time_table_param_ids.size();
+    const double* values = time_table.data() + time_table_index * num_params;
+    for (int i = 0; i < num_params; i++) {
+      parameter_values[time_table_param_ids[i]] = values[i];
+    }
+    for (auto& param : parameters) {
+      if (param.is_constant) {
+        parameter_values[param.id] = param.value;
+      }
+    }
+  } else {
+    for (auto& param : parameters) {
+      parameter_values[param.id] = param.get(time);
+    }
   }
 
-  for (auto block : blocks) {
+  // The qualified calls of the concrete block types are resolved statically
+  block_groups.for_each([&](const auto& group) {
+    using T = group_block_t<decltype(group)>;
+    if constexpr (overrides_update_time<T>) {
+      for (auto block : group) {
+        block->T::update_time(system, parameter_values);
+      }
+    }
+  });
+  for (auto block : ungrouped_blocks) {
     block->update_time(system, parameter_values);
   }
 }
@@ -210,18 +395,171 @@ void Model::update_time(SparseSystem& system, double time) {
 void Model::update_solution(SparseSystem& system,
                             Eigen::Matrix<double, Eigen::Dynamic, 1>& y,
                             Eigen::Matrix<double, Eigen::Dynamic, 1>& dy) {
-  for (auto block : blocks) {
+  block_groups.for_each([&](const auto& group) {
+    using T = group_block_t<decltype(group)>;
+    if constexpr (std::is_same_v<T, BloodVessel>) {
+      if (use_blood_vessel_batch) {
+        blood_vessel_batch.update_solution(system, parameter_values, y, dy);
+        return;
+      }
+    }
+    if constexpr (overrides_update_solution<T>) {
+      for (auto block : group) {
+        block->T::update_solution(system, parameter_values, y, dy);
+      }
+    }
+  });
+  for (auto block : ungrouped_blocks) {
     block->update_solution(system, parameter_values, y, dy);
   }
 }
 
 void Model::post_solve(Eigen::Matrix<double, Eigen::Dynamic, 1>& y) {
-  for (auto block : blocks) {
+  block_groups.for_each([&](const auto& group) {
+    using T = group_block_t<decltype(group)>;
+    if constexpr (overrides_post_solve<T>) {
+      for (auto block : group) {
+        block->T::post_solve(y);
+      }
+    }
+  });
+  for (auto block : ungrouped_blocks) {
     block->post_solve(y);
   }
 }
 
+int Model::get_num_switching_functions() const {
+  int num_switching_functions = 0;
+  for (auto& block : blocks) {
+    num_switching_functions += block->get_num_switching_functions();
+  }
+  return num_switching_functions;
+}
+
+void Model::get_switching_functions(
+    const Eigen::Matrix<double, Eigen::Dynamic, 1>& y,
+    std::vector<double>& values) const {
+  values.clear();
+  for (auto& block : blocks) {
+    block->get_switching_functions(y, values);
+  }
+}
+
+void Model::update_discrete_states(
+    const Eigen::Matrix<double, Eigen::Dynamic, 1>& y) {
+  for (auto& block : blocks) {
+    block->update_discrete_state(y);
+  }
+}
+
+bool Model::is_linear_time_invariant() const {
+  for (auto& block : blocks) {
+    if (!block->is_linear_time_invariant()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Model::is_steady_time_invariant() const {
+  for (auto& block : blocks) {
+    if (!block->is_steady_time_invariant()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Model::modifies_solution() const {
+  for (auto& block : blocks) {
+    if (block->modifies_solution()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Model::enable_time_tables(double time_step_size, double offset) {
+  time_table_step_size = time_step_size;
+  time_table_offset = offset;
+  time_tables_valid = false;
+}
+
+void Model::build_time_tables() {
+  DEBUG_MSG("Build time tables");
+  time_tables_valid = true;
+  time_table_num_steps = 0;
+  time_table_param_ids.clear();
+  time_table.clear();
+  for (auto& block : blocks) {
+    if (auto activation_func = block->get_activation_function()) {
+      activation_func->clear_table();
+    }
+  }
+
+  // Check if the time steps divide the cardiac cycle
+  if (cardiac_cycle_period <= 0.0) {
+    return;
+  }
+  int num_steps = std::round(cardiac_cycle_period / time_table_step_size);
+  if ((num_steps < 1) ||
+      (std::abs(num_steps * time_table_step_size - cardiac_cycle_period) >
+       1.0e-10 * cardiac_cycle_period)) {
+    return;
+  }
+
+  // Check if all time-dependent parameters are periodic
+  for (auto& param : parameters) {
+    if (!param.is_constant) {
+      if (!param.is_periodic) {
+        return;
+      }
+      time_table_param_ids.push_back(param.id);
+    }
+  }
+
+  std::vector<double> times(num_steps);
+  for (int i = 0; i < num_steps; i++) {
+    times[i] = time_table_offset + i * time_table_step_size;
+  }
+  time_table.reserve(num_steps * time_table_param_ids.size());
+  for (double time : times) {
+    for (int param_id : time_table_param_ids) {
+      time_table.push_back(parameters[param_id].get(time));
+    }
+  }
+  for (auto& block : blocks) {
+    if (auto activation_func = block->get_activation_function()) {
+      activation_func->tabulate(times, cardiac_cycle_period);
+    }
+  }
+  time_table_num_steps = num_steps;
+}
+
+int Model::find_time_table_index(double time) {
+  if (time_table_step_size <= 0.0) {
+    return -1;
+  }
+  if (!time_tables_valid) {
+    build_time_tables();
+  }
+  if (time_table_num_steps == 0) {
+    return -1;
+  }
+
+  // Only times on the grid of the table (up to round-off) are tabulated
+  double step = (std::fmod(time, cardiac_cycle_period) - time_table_offset) /
+                time_table_step_size;
+  double step_rounded = std::round(step);
+  if (std::abs(step - step_rounded) > 1.0e-6) {
+    return -1;
+  }
+  int index = int(step_rounded) % time_table_num_steps;
+  return (index < 0) ? index + time_table_num_steps : index;
+}
+
 void Model::to_steady() {
+  time_tables_valid = false;
   for (auto& param : parameters) {
     param.to_steady();
   }
@@ -233,13 +571,14 @@ void Model::to_steady() {
         (block_types[i] == BlockType::closed_loop_rcr_bc)) {
       int param_id_capacitance = blocks[i]->global_param_ids[1];
       double value = parameters[param_id_capacitance].get(0.0);
-      param_value_cache.insert({param_id_capacitance, value});
+      param_value_cache[param_id_capacitance] = value;
       parameters[param_id_capacitance].update(0.0);
     }
   }
 }
 
 void Model::to_unsteady() {
+  time_tables_valid = false;
   for (auto& param : parameters) {
     param.to_unsteady();
   }
@@ -262,6 +601,17 @@ TripletsContributions Model::get_num_triplets() const {
   return triplets_sum;
 }
 
+std::vector<std::pair<int, int>> Model::get_slot_entries() const {
+  std::vector<std::pair<int, int>> entries;
+  for (auto& block : blocks) {
+    for (auto& [eqn, var] : block->slot_entries) {
+      entries.push_back(
+          {block->global_eqn_ids[eqn], block->global_var_ids[var]});
+    }
+  }
+  return entries;
+}
+
 void Model::setup_initial_state_dependent_parameters(State initial_state) {
   DEBUG_MSG("Setup initial state dependent parameters");
   for (auto& block : blocks) {
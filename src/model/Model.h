@@ -13,6 +13,8 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <tuple>
+#include <typeinfo>
 #include <vector>
 
 #include "Block.h"
@@ -42,6 +44,76 @@
 #include "WindkesselBC.h"
 #include "debug.h"
 
+// Blocks that include this header (declared for Model::block_groups)
+class ChamberElastanceInductor;
+class LinearElastanceChamber;
+
+/**
+ * @brief Blocks of a model grouped by their concrete type
+ *
+ * Each group is a contiguous list of blocks of exactly one of the types
+ * `BlockClasses`. Iterating over a group with for_each passes the blocks as
+ * pointers to their concrete type, such that the model can call the block
+ * functions without virtual dispatch.
+ *
+ * @tparam BlockClasses Concrete block types with a group
+ */
+template <typename... BlockClasses>
+class BlockGroups {
+ public:
+  /**
+   * @brief Add a block to the group of its concrete type
+   *
+   * @param block The block to add
+   * @return bool False if the concrete type of the block has no group
+   */
+  bool add(Block* block) { return (add_if<BlockClasses>(block) || ...); }
+
+  /**
+   * @brief Remove all blocks from the groups
+   *
+   */
+  void clear() {
+    std::apply([](auto&... group) { (group.clear(), ...); }, groups);
+  }
+
+  /**
+   * @brief Get the group of a block type
+   *
+   * @tparam T Concrete block type
+   * @return const std::vector<T*>& Blocks of the type
+   */
+  template <typename T>
+  const std::vector<T*>& get() const {
+    return std::get<std::vector<T*>>(groups);
+  }
+
+  /**
+   * @brief Call a function for each group
+   *
+   * The function is called with the vector of pointers to the blocks of the
+   * group (also for empty groups).
+   *
+   * @param func Function to call
+   */
+  template <typename Func>
+  void for_each(Func&& func) const {
+    std::apply([&](const auto&... group) { (func(group), ...); }, groups);
+  }
+
+ private:
+  std::tuple<std::vector<BlockClasses*>...> groups;
+
+  template <typename T>
+  bool add_if(Block* block) {
+    if (typeid(*block) != typeid(T)) {
+      return false;
+    }
+    std::get<std::vector<T*>>(groups).push_back(static_cast<T*>(block));
+    return true;
+  }
+};
+
 /**
  * @brief Model of 0D elements
  *
@@ -54,6 +126,9 @@ class Model {
   /// Factory that holds all implemented blocks
   std::map<std::string_view, BlockFactoryFunc> block_factory_map;
 
+  /// Copy functions of all implemented blocks (see clone)
+  std::map<BlockType, BlockCloneFunc> block_clone_map;
+
   /**
    * @brief Construct a new Model object
    *
@@ -66,10 +141,26 @@ class Model {
    */
   ~Model();
 
+  /**
+   * @brief Create an independent copy of the model
+   *
+   * The copy has its own blocks (including their activation functions),
+   * nodes, parameters and degree-of-freedom handler, with the same global
+   * IDs and current parameter values as this model. It can be simulated in
+   * another thread without parsing the configuration again. The time tables
+   * (see enable_time_tables) are rebuilt on first use.
+   *
+   * @return std::unique_ptr<Model> The copy of the model
+   */
+  std::unique_ptr<Model> clone() const;
+
   DOFHandler dofhandler;  ///< Degree-of-freedom handler of the model
 
   double cardiac_cycle_period = -1.0;  ///< Cardiac cycle period
   double time = 0.0;                   ///< Current time
+  bool freeze_discrete_states =
+      false;  ///< Keep the discrete states of the blocks (e.g. valve
+              ///< positions) in update_solution (see update_discrete_states)
 
   /**
    * @brief Create a new block
@@ -209,6 +300,24 @@ class Model {
    */
   void update_parameter_value(int param_id, double param_value);
 
+  /**
+   * @brief Set the interpolation of all time-dependent parameters
+   *
+   * @param method Interpolation method
+   * @param num_resample_points Number of points of the uniform grid the
+   * parameters are resampled to (0: no resampling)
+   */
+  void set_parameter_interpolation(InterpolationMethod method,
+                                   int num_resample_points = 0);
+
+  /**
+   * @brief Check if a parameter is constant in time
+   *
+   * @param param_id Global ID of the parameter
+   * @return bool True if the parameter is constant
+   */
+  bool is_constant_parameter(int param_id) const;
+
   /**
    * @brief Finalize the model after all blocks, nodes and parameters have been
    * added
@@ -251,6 +360,91 @@ class Model {
    */
   void post_solve(Eigen::Matrix<double, Eigen::Dynamic, 1>& y);
 
+  /**
+   * @brief Get the number of switching functions of all elements
+   *
+   * @return int Number of switching functions (see
+   * Block::get_switching_functions)
+   */
+  int get_num_switching_functions() const;
+
+  /**
+   * @brief Evaluate the switching functions of all elements
+   *
+   * @param y Current solution
+   * @param values Values of the switching functions in the order of the
+   * blocks
+   */
+  void get_switching_functions(
+      const Eigen::Matrix<double, Eigen::Dynamic, 1>& y,
+      std::vector<double>& values) const;
+
+  /**
+   * @brief Set the discrete states of all elements from the solution
+   *
+   * @param y Current solution
+   */
+  void update_discrete_states(
+      const Eigen::Matrix<double, Eigen::Dynamic, 1>& y);
+
+  /**
+   * @brief Check if the model is linear and time-invariant
+   *
+   * This is the case if all blocks are linear and time-invariant (see
+   * Block::is_linear_time_invariant). The jacobian of the system is then
+   * constant and each time step is a single linear solve.
+   *
+   * @return bool True if the model is linear and time-invariant
+   */
+  bool is_linear_time_invariant() const;
+
+  /**
+   * @brief Check if the model is time-invariant in its steady behavior
+   *
+   * This is the case if all blocks are (see
+   * Block::is_steady_time_invariant). Otherwise, the model has no steady
+   * state.
+   *
+   * @return bool True if the steady model is time-invariant
+   */
+  bool is_steady_time_invariant() const;
+
+  /**
+   * @brief Check if any block modifies the solution in post_solve
+   *
+   * The non-linear iterations of such models must start from the constant
+   * predictor and factorize the Jacobian in each iteration (see
+   * Block::modifies_solution).
+   *
+   * @return bool True if any block modifies the solution
+   */
+  bool modifies_solution() const;
+
+  /**
+   * @brief Tabulate the time-dependent parameters and activation functions at
+   * the time steps of a cardiac cycle
+   *
+   * With a uniform time step size, all periodic parameters and activation
+   * functions take the same values in each cardiac cycle. update_time then
+   * reads the values at the times `offset + i * time_step_size` (modulo the
+   * cardiac cycle) from a table instead of evaluating them; other times are
+   * evaluated as usual. The tables are built on first use and rebuilt after
+   * the parameters are modified (get_parameter, to_steady, to_unsteady). No
+   * tables are used if a time-dependent parameter is not periodic or the
+   * time step size does not divide the cardiac cycle.
+   *
+   * @param time_step_size Time step size
+   * @param offset Offset of the evaluation times within a time step
+   */
+  void enable_time_tables(double time_step_size, double offset);
+
+  /**
+   * @brief Get the index of the current time in the time tables
+   *
+   * @return int Index of the current time in the tables (-1: not tabulated)
+   */
+  int get_time_table_index() const { return time_table_index; }
+
   /**
    * @brief Convert the blocks to a steady behavior
    *
@@ -274,6 +468,18 @@ class Model {
   // std::map<std::string, int> get_num_triplets();
   TripletsContributions get_num_triplets() const;
 
+  /**
+   * @brief Get the matrix entries that the elements write in update_time and
+   * update_solution
+   *
+   * The entries of all elements are concatenated in the order of the blocks,
+   * starting at Block::slot_offset for each block.
+   *
+   * @return std::vector<std::pair<int, int>> Global (row, column) indices of
+   * the entries
+   */
+  std::vector<std::pair<int, int>> get_slot_entries() const;
+
   /**
    * @brief Get the number of blocks in the model
    *
@@ -348,8 +554,55 @@ class Model {
                          ///< `update_constant`, `update_time` and
                          ///< `update_solution`.
 
+  BlockGroups<BloodVessel, BloodVesselCRL, BloodVesselJunction,
+              ChamberElastanceInductor, ChamberSphere, ClosedLoopCoronaryLeftBC,
+              ClosedLoopCoronaryRightBC, ClosedLoopHeartPulmonary,
+              ClosedLoopRCRBC, FlowReferenceBC, Junction,
+              LinearElastanceChamber, OpenLoopCoronaryBC, PiecewiseValve,
+              PressureReferenceBC, ResistanceBC, ResistiveJunction, ValveTanh,
+              WindkesselBC>
+      block_groups;  ///< Blocks grouped by type for update_time,
+                     ///< update_solution and post_solve
+  std::vector<Block*>
+      ungrouped_blocks;  ///< Blocks of a type without group (virtual calls)
+  BloodVesselBatch
+      blood_vessel_batch;  ///< Batched update_solution of all BloodVessels
+  bool use_blood_vessel_batch = false;  ///< Is blood_vessel_batch used?
+
+  double time_table_step_size = 0.0;  ///< Time step size of the time tables
+                                      ///< (0: no tables)
+  double time_table_offset = 0.0;     ///< Offset of the time table times
+  int time_table_num_steps = 0;       ///< Number of time steps in the tables
+  bool time_tables_valid = false;     ///< Are the time tables up to date?
+  int time_table_index = -1;          ///< Index of the current time in tables
+  std::vector<int>
+      time_table_param_ids;  ///< Global IDs of the tabulated parameters
+  std::vector<double>
+      time_table;  ///< Tabulated parameter values (one row per time step)
+
   bool has_windkessel_bc = false;
   double largest_windkessel_time_constant = 0.0;
+
+  /**
+   * @brief Group the blocks by type and set up the batched evaluation of the
+   * blood vessels (if there are enough of them)
+   *
+   */
+  void group_blocks();
+
+  /**
+   * @brief Build the time tables (see enable_time_tables)
+   *
+   */
+  void build_time_tables();
+
+  /**
+   * @brief Find the index of a time in the time tables
+   *
+   * @param time Time
+   * @return int Index of the time in the tables (-1: not tabulated)
+   */
+  int find_time_table_index(double time);
 };
 
 #endif  // SVZERODSOLVER_MODEL_MODEL_HPP_
@@ -75,3 +75,5 @@ void OpenLoopCoronaryBC::setup_initial_state_dependent_params(
   // Initial intramyocardial pressure
   this->Pim_0 = parameters[global_param_ids[5]];
 }
+
+bool OpenLoopCoronaryBC::is_linear_time_invariant() const { return true; }
@@ -2,6 +2,9 @@
 // University of California, and others. SPDX-License-Identifier: BSD-3-Clause
 #include "Parameter.h"
 
+#include <Eigen/Sparse>
+#include <stdexcept>
+
 Parameter::Parameter(int id, double value) {
   this->id = id;
   update(value);
@@ -32,7 +35,132 @@ void Parameter::update(const std::vector<double>& update_times,
     values = update_values;
     cycle_period = update_times.back() - update_times[0];
     is_constant = false;
+    setup_interpolation();
+  }
+}
+
+void Parameter::set_interpolation(InterpolationMethod method,
+                                  int num_resample_points) {
+  if (num_resample_points == 1 || num_resample_points < 0) {
+    throw std::runtime_error(
+        "Number of resampling points of a parameter must be 0 or at least 2");
+  }
+  interpolation = method;
+  this->num_resample_points = num_resample_points;
+  if (!is_constant || steady_converted) {
+    setup_interpolation();
+  }
+}
+
+void Parameter::setup_interpolation() {
+  spline_b.clear();
+  spline_c.clear();
+  spline_d.clear();
+  uniform_values.clear();
+  last_index = 0;
+
+  // Values at the times (the end of a periodic sequence is its start)
+  auto y = [&](int i) {
+    return (is_periodic && i == size - 1) ? values[0] : values[i];
+  };
+  auto h = [&](int i) { return times[i + 1] - times[i]; };
+
+  if (interpolation == InterpolationMethod::cubic_spline) {
+    // Solve for the second derivatives of the spline at the times. A periodic
+    // spline has one unknown less (the last time is the first of the next
+    // cycle) and the equations wrap around. Otherwise, the spline is natural
+    // (zero second derivative at both ends).
+    int num_unknowns = is_periodic ? size - 1 : size;
+    std::vector<Eigen::Triplet<double>> triplets;
+    Eigen::VectorXd rhs = Eigen::VectorXd::Zero(num_unknowns);
+    for (int i = 0; i < num_unknowns; i++) {
+      if (!is_periodic && (i == 0 || i == size - 1)) {
+        triplets.emplace_back(i, i, 1.0);
+        continue;
+      }
+      int prev = (i + num_unknowns - 1) % num_unknowns;
+      int next = (i + 1) % num_unknowns;
+      double h_prev = h(prev);
+      double h_next = h(i);
+      triplets.emplace_back(i, prev, h_prev);
+      triplets.emplace_back(i, i, 2.0 * (h_prev + h_next));
+      triplets.emplace_back(i, next, h_next);
+      rhs[i] = 6.0 * ((y(i + 1) - y(i)) / h_next - (y(i) - y(prev)) / h_prev);
+    }
+    Eigen::SparseMatrix<double> matrix(num_unknowns, num_unknowns);
+    matrix.setFromTriplets(triplets.begin(), triplets.end());
+    Eigen::SparseLU<Eigen::SparseMatrix<double>> lu(matrix);
+    if (lu.info() != Eigen::Success) {
+      throw std::runtime_error("Cubic spline of parameter " +
+                               std::to_string(id) + " could not be set up");
+    }
+    Eigen::VectorXd second_derivs = lu.solve(rhs);
+
+    // Polynomial coefficients of each interval
+    auto second_deriv = [&](int i) {
+      return second_derivs[i % num_unknowns];
+    };
+    for (int i = 0; i < size - 1; i++) {
+      spline_b.push_back((y(i + 1) - y(i)) / h(i) -
+                         h(i) * (2.0 * second_deriv(i) + second_deriv(i + 1)) /
+                             6.0);
+      spline_c.push_back(0.5 * second_deriv(i));
+      spline_d.push_back((second_deriv(i + 1) - second_deriv(i)) /
+                         (6.0 * h(i)));
+    }
+  }
+
+  if (num_resample_points > 0) {
+    std::vector<double> resampled(num_resample_points);
+    uniform_step = (times.back() - times[0]) / (num_resample_points - 1);
+    for (int i = 0; i < num_resample_points - 1; i++) {
+      resampled[i] = interpolate(times[0] + i * uniform_step);
+    }
+    resampled.back() = interpolate(times.back());
+    uniform_values = std::move(resampled);
+    last_index = 0;
+  }
+}
+
+int Parameter::find_index(double rtime) {
+  int k = last_index;
+  if ((k > 0) && (times[k - 1] >= rtime)) {
+    // Time moved backward
+    k = std::lower_bound(times.begin(), times.begin() + k, rtime) -
+        times.begin();
+  } else if ((k < size) && (times[k] < rtime)) {
+    // Time moved forward, most likely into the next interval
+    k++;
+    if ((k < size) && (times[k] < rtime)) {
+      k = std::lower_bound(times.begin() + k + 1, times.end(), rtime) -
+          times.begin();
+    }
+  }
+  last_index = k;
+  return k;
+}
+
+double Parameter::interpolate(double rtime) {
+  // Determine the lower and upper element for interpolation
+  int k = find_index(rtime);
+
+  if (k == size) {
+    k = size - 1;
+  } else if (times[k] == rtime) {
+    return values[k];
   }
+
+  if (interpolation == InterpolationMethod::cubic_spline) {
+    int i = std::clamp(k - 1, 0, size - 2);
+    double dt = rtime - times[i];
+    return values[i] +
+           dt * (spline_b[i] + dt * (spline_c[i] + dt * spline_d[i]));
+  }
+
+  // Perform linear interpolation
+  int m = k ? k - 1 : 1;
+  return values[m] +
+         ((values[k] - values[m]) / (times[k] - times[m])) * (rtime - times[m]);
 }
 
 double Parameter::get(double time) {
@@ -51,21 +179,16 @@ double Parameter::get(double time) {
     rtime = time;
   }
 
-  // Determine the lower and upper element for interpolation
-  auto i = lower_bound(times.begin(), times.end(), rtime);
-  int k = i - times.begin();
-
-  if (i == times.end()) {
-    --i;
-  } else if (*i == rtime) {
-    return values[k];
+  // Look up the resampled values on the uniform grid
+  if (!uniform_values.empty()) {
+    double x = (rtime - times[0]) / uniform_step;
+    int i = std::clamp(static_cast<int>(std::floor(x)), 0,
+                       static_cast<int>(uniform_values.size()) - 2);
+    return uniform_values[i] +
+           (uniform_values[i + 1] - uniform_values[i]) * (x - i);
   }
-  int m = k ? k - 1 : 1;
 
-  // Perform linear interpolation
-  // TODO: Implement periodic cubic spline
-  return values[m] +
-         ((values[k] - values[m]) / (times[k] - times[m])) * (rtime - times[m]);
+  return interpolate(rtime);
 }
 
 void Parameter::to_steady() {
@@ -15,6 +15,15 @@
 
 #include "DOFHandler.h"
 
+/**
+ * @brief Interpolation method of time-dependent parameters
+ *
+ */
+enum class InterpolationMethod {
+  linear = 0,        ///< Piecewise linear interpolation
+  cubic_spline = 1,  ///< Cubic spline (periodic if the parameter is periodic)
+};
+
 /**
  * @brief Model Parameter.
  *
@@ -53,6 +62,12 @@ class Parameter {
   bool is_constant;  ///< Bool value indicating if the parameter is constant
   bool is_periodic;  ///< Bool value indicating if the parameter is periodic
                      ///< with the cardiac cycle
+  InterpolationMethod interpolation =
+      InterpolationMethod::linear;  ///< Interpolation method if parameter is
+                                    ///< time-dependent
+  int num_resample_points = 0;  ///< Number of points of the uniform grid the
+                                ///< parameter is resampled to (0: no
+                                ///< resampling)
 
   /**
    * @brief Update the parameter
@@ -70,9 +85,26 @@ class Parameter {
   void update(const std::vector<double>& times,
               const std::vector<double>& values);
 
+  /**
+   * @brief Set the interpolation of the time-dependent values
+   *
+   * With resampling, the interpolated values are evaluated once on a uniform
+   * time grid with `num_resample_points` points, which is then interpolated
+   * linearly with constant cost per evaluation.
+   *
+   * @param method Interpolation method
+   * @param num_resample_points Number of points of the uniform grid (0: no
+   * resampling)
+   */
+  void set_interpolation(InterpolationMethod method,
+                         int num_resample_points = 0);
+
   /**
    * @brief Get the parameter value at the specified time.
    *
+   * The interval of the last evaluation is cached, such that the lookup is
+   * constant for time moving forward in small steps.
+   *
    * @param time Current time
    * @return Value at the time
    */
@@ -92,6 +124,40 @@ class Parameter {
 
  private:
   bool steady_converted = false;
+  int last_index = 0;  ///< Result of the last lookup in `times`
+
+  // Coefficients of the cubic spline in each interval
+  std::vector<double> spline_b;
+  std::vector<double> spline_c;
+  std::vector<double> spline_d;
+
+  // Values resampled to a uniform grid starting at `times[0]`
+  std::vector<double> uniform_values;
+  double uniform_step = 0.0;
+
+  /**
+   * @brief Set up the spline coefficients and the uniform grid
+   *
+   */
+  void setup_interpolation();
+
+  /**
+   * @brief Get the index of the first time that is not less than `rtime`
+   *
+   * Same as `std::lower_bound` on `times`, starting at the last index.
+   *
+   * @param rtime Time within `times`
+   * @return int Index of the first time that is not less than `rtime`
+   */
+  int find_index(double rtime);
+
+  /**
+   * @brief Interpolate the time-dependent values
+   *
+   * @param rtime Time within `times`
+   * @return double Interpolated value
+   */
+  double interpolate(double rtime);
 };
 
 /**
@@ -3,10 +3,13 @@
 
 #include "PiecewiseValve.h"
 
+#include "Model.h"
+
 void PiecewiseValve::setup_dofs(DOFHandler& dofhandler) {
   // set_up_dofs args: dofhandler (passed in), num equations, list of internal
   // variable names (strings) 2 eqns, one for Pressure, one for Flow
   Block::setup_dofs_(dofhandler, 2, {});
+  slot_entries = {{0, 1}};
 }
 
 // update_constant updates matrices E and F from E(y,t)*y_dot + F(y,t)*y +
@@ -42,13 +45,23 @@ void PiecewiseValve::update_solution(
   double Rmin = parameters[global_param_ids[ParamId::RMIN]];
   double Rmax = parameters[global_param_ids[ParamId::RMAX]];
 
-  double resistance = 0;
-
-  if (p_out < p_in) {
-    resistance = Rmin;
-  } else {
-    resistance = Rmax;
+  if (!model->freeze_discrete_states) {
+    open = p_out < p_in;
   }
+  double resistance = open ? Rmin : Rmax;
+
+  system.F.valuePtr()[get_slots(system)[0]] = -resistance;
+}
+
+int PiecewiseValve::get_num_switching_functions() const { return 1; }
+
+void PiecewiseValve::get_switching_functions(
+    const Eigen::Matrix<double, Eigen::Dynamic, 1>& y,
+    std::vector<double>& values) const {
+  values.push_back(y[global_var_ids[0]] - y[global_var_ids[2]]);
+}
 
-  system.F.coeffRef(global_eqn_ids[0], global_var_ids[1]) = -resistance;
+void PiecewiseValve::update_discrete_state(
+    const Eigen::Matrix<double, Eigen::Dynamic, 1>& y) {
+  open = y[global_var_ids[2]] < y[global_var_ids[0]];
 }
@@ -144,6 +144,32 @@ class PiecewiseValve : public Block {
                        const Eigen::Matrix<double, Eigen::Dynamic, 1>& y,
                        const Eigen::Matrix<double, Eigen::Dynamic, 1>& dy);
 
+  /**
+   * @brief Get the number of switching functions of the element
+   *
+   * @return int Number of switching functions
+   */
+  int get_num_switching_functions() const;
+
+  /**
+   * @brief Evaluate the switching function of the element (the pressure
+   * difference across the valve)
+   *
+   * @param y Current solution
+   * @param values Values of the switching functions
+   */
+  void get_switching_functions(
+      const Eigen::Matrix<double, Eigen::Dynamic, 1>& y,
+      std::vector<double>& values) const;
+
+  /**
+   * @brief Set the valve position from the solution
+   *
+   * @param y Current solution
+   */
+  void update_discrete_state(
+      const Eigen::Matrix<double, Eigen::Dynamic, 1>& y);
+
   /**
    * @brief Number of triplets of element
    *
@@ -151,6 +177,9 @@ class PiecewiseValve : public Block {
    * (relevant for sparse memory reservation)
    */
   TripletsContributions num_triplets{5, 0, 3};
+
+ private:
+  bool open = false;  ///< Is the valve open (minimum resistance)?
 };
 
 #endif  // SVZERODSOLVER_MODEL_PiecewiseValve_HPP_
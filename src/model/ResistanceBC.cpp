@@ -2,8 +2,11 @@
 // University of California, and others. SPDX-License-Identifier: BSD-3-Clause
 #include "ResistanceBC.h"
 
+#include "Model.h"
+
 void ResistanceBC::setup_dofs(DOFHandler& dofhandler) {
   Block::setup_dofs_(dofhandler, 1, {});
+  slot_entries = {{0, 1}};
 }
 
 void ResistanceBC::update_constant(SparseSystem& system,
@@ -13,7 +16,10 @@ void ResistanceBC::update_constant(SparseSystem& system,
 
 void ResistanceBC::update_time(SparseSystem& system,
                                std::vector<double>& parameters) {
-  system.F.coeffRef(global_eqn_ids[0], global_var_ids[1]) =
-      -parameters[global_param_ids[0]];
+  system.F.valuePtr()[get_slots(system)[0]] = -parameters[global_param_ids[0]];
   system.C(global_eqn_ids[0]) = -parameters[global_param_ids[1]];
 }
+
+bool ResistanceBC::is_linear_time_invariant() const {
+  return model->is_constant_parameter(global_param_ids[0]);
+}
@@ -39,3 +39,5 @@ void ResistiveJunction::update_constant(SparseSystem& system,
                       global_var_ids[i]) = -1.0;
   }
 }
+
+bool ResistiveJunction::is_linear_time_invariant() const { return true; }
@@ -7,6 +7,7 @@ void ValveTanh::setup_dofs(DOFHandler& dofhandler) {
   // variable names (strings) 3 eqns, one for Pressure, one for Flow, one for
   // the valve status output
   Block::setup_dofs_(dofhandler, 3, {"valve_status"});
+  slot_entries = {{0, 0}, {0, 1}, {0, 2}, {2, 0}, {2, 2}};
 }
 
 // update_constant updates matrices E and F from E(y,t)*y_dot + F(y,t)*y +
@@ -54,12 +55,12 @@ void ValveTanh::update_solution(
   system.C(global_eqn_ids[2]) = -0.5 * (1 + fun_tanh);
 
   // Derivatives of non-linear terms
-  system.dC_dy.coeffRef(global_eqn_ids[0], global_var_ids[0]) =
+  auto slots = get_slots(system);
+  system.dC_dy.valuePtr()[slots[0]] =
       0.5 * q_in * (Rmax - Rmin) * steep * (1.0 - pow(fun_tanh, 2));
-  system.dC_dy.coeffRef(global_eqn_ids[0], global_var_ids[1]) =
-      -0.5 * (Rmax - Rmin) * fun_tanh;
-  system.dC_dy.coeffRef(global_eqn_ids[0], global_var_ids[2]) =
+  system.dC_dy.valuePtr()[slots[1]] = -0.5 * (Rmax - Rmin) * fun_tanh;
+  system.dC_dy.valuePtr()[slots[2]] =
       -0.5 * q_in * (Rmax - Rmin) * steep * (1.0 - pow(fun_tanh, 2));
-  system.dC_dy.coeffRef(global_eqn_ids[2], global_var_ids[0]) = fun_cosh;
-  system.dC_dy.coeffRef(global_eqn_ids[2], global_var_ids[2]) = -fun_cosh;
+  system.dC_dy.valuePtr()[slots[3]] = fun_cosh;
+  system.dC_dy.valuePtr()[slots[4]] = -fun_cosh;
 }
@@ -2,8 +2,11 @@
 // University of California, and others. SPDX-License-Identifier: BSD-3-Clause
 #include "WindkesselBC.h"
 
+#include "Model.h"
+
 void WindkesselBC::setup_dofs(DOFHandler& dofhandler) {
   Block::setup_dofs_(dofhandler, 2, {"pressure_c"});
+  slot_entries = {{1, 2}, {0, 1}, {1, 1}};
 }
 
 void WindkesselBC::update_constant(SparseSystem& system,
@@ -17,11 +20,16 @@ void WindkesselBC::update_constant(SparseSystem& system,
 void WindkesselBC::update_time(SparseSystem& system,
 
                                std::vector<double>& parameters) {
-  system.E.coeffRef(global_eqn_ids[1], global_var_ids[2]) =
+  auto slots = get_slots(system);
+  system.E.valuePtr()[slots[0]] =
       -parameters[global_param_ids[2]] * parameters[global_param_ids[1]];
-  system.F.coeffRef(global_eqn_ids[0], global_var_ids[1]) =
-      -parameters[global_param_ids[0]];
-  system.F.coeffRef(global_eqn_ids[1], global_var_ids[1]) =
-      parameters[global_param_ids[2]];
+  system.F.valuePtr()[slots[1]] = -parameters[global_param_ids[0]];
+  system.F.valuePtr()[slots[2]] = parameters[global_param_ids[2]];
   system.C(global_eqn_ids[1]) = parameters[global_param_ids[3]];
 }
+
+bool WindkesselBC::is_linear_time_invariant() const {
+  return model->is_constant_parameter(global_param_ids[0]) &&
+         model->is_constant_parameter(global_param_ids[1]) &&
+         model->is_constant_parameter(global_param_ids[2]);
+}
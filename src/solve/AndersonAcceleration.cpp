@@ -0,0 +1,45 @@
+// SPDX-FileCopyrightText: Copyright (c) Stanford University, The Regents of the
+// University of California, and others. SPDX-License-Identifier: BSD-3-Clause
+#include "AndersonAcceleration.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+AndersonAcceleration::AndersonAcceleration(int memory) : memory(memory) {
+  if (memory < 1) {
+    throw std::runtime_error(
+        "Memory of Anderson acceleration must be at least 1");
+  }
+}
+
+Eigen::VectorXd AndersonAcceleration::update(const Eigen::VectorXd& x,
+                                             const Eigen::VectorXd& g) {
+  if (scale.size() == 0) {
+    scale = g.cwiseAbs();
+    double floor = std::max(1.0e-6 * scale.maxCoeff(), 1.0e-12);
+    scale = scale.cwiseMax(floor);
+  }
+
+  residuals.push_back((g - x).cwiseQuotient(scale));
+  images.push_back(g);
+  if (int(residuals.size()) > memory + 1) {
+    residuals.pop_front();
+    images.pop_front();
+  }
+  int num_columns = residuals.size() - 1;
+  if (num_columns == 0) {
+    return g;
+  }
+
+  // Differences of consecutive residuals and images
+  Eigen::MatrixXd delta_residuals(x.size(), num_columns);
+  Eigen::MatrixXd delta_images(x.size(), num_columns);
+  for (int i = 0; i < num_columns; i++) {
+    delta_residuals.col(i) = residuals[i + 1] - residuals[i];
+    delta_images.col(i) = images[i + 1] - images[i];
+  }
+
+  Eigen::VectorXd gamma =
+      delta_residuals.colPivHouseholderQr().solve(residuals.back());
+  return g - delta_images * gamma;
+}
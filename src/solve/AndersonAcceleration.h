@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: Copyright (c) Stanford University, The Regents of the
+// University of California, and others. SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file AndersonAcceleration.h
+ * @brief AndersonAcceleration source file
+ */
+#ifndef SVZERODSOLVER_SOLVE_ANDERSONACCELERATION_HPP_
+#define SVZERODSOLVER_SOLVE_ANDERSONACCELERATION_HPP_
+
+#include <Eigen/Dense>
+#include <deque>
+
+/**
+ * @brief Anderson acceleration of a fixed-point iteration
+ *
+ * Accelerates the iteration \f$x_{k+1} = g(x_k)\f$ by combining the last
+ * \f$m+1\f$ iterates. With the residuals \f$f_k = g(x_k) - x_k\f$, the next
+ * iterate is
+ *
+ * \f[
+ * x_{k+1} = g(x_k) - \Delta G_k \gamma_k, \quad
+ * \gamma_k = \arg\min_\gamma \|f_k - \Delta F_k \gamma\|_2,
+ * \f]
+ *
+ * where the columns of \f$\Delta F_k\f$ and \f$\Delta G_k\f$ are the
+ * differences of consecutive residuals and images \f$g(x_i)\f$. The
+ * residuals are scaled component-wise with the magnitude of the first image.
+ * With \f$m = 1\f$, this is the vector Aitken (Irons-Tuck) extrapolation.
+ */
+class AndersonAcceleration {
+ public:
+  /**
+   * @brief Construct a new AndersonAcceleration object
+   *
+   * @param memory Number of previous iterates used (m)
+   */
+  AndersonAcceleration(int memory = 3);
+
+  /**
+   * @brief Get the next iterate
+   *
+   * The first call returns the plain fixed-point iterate \f$g(x_0)\f$.
+   *
+   * @param x Current iterate
+   * @param g Image of the current iterate under the fixed-point map
+   * @return Eigen::VectorXd Next iterate
+   */
+  Eigen::VectorXd update(const Eigen::VectorXd& x, const Eigen::VectorXd& g);
+
+ private:
+  int memory;
+  Eigen::VectorXd scale;
+  std::deque<Eigen::VectorXd> residuals;
+  std::deque<Eigen::VectorXd> images;
+};
+
+#endif  // SVZERODSOLVER_SOLVE_ANDERSONACCELERATION_HPP_
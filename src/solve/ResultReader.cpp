@@ -0,0 +1,194 @@
+// SPDX-FileCopyrightText: Copyright (c) Stanford University, The Regents of the
+// University of California, and others. SPDX-License-Identifier: BSD-3-Clause
+#include "ResultReader.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+ResultReader::ResultReader(const std::string& filename) {
+  // Map the file
+  std::string error = "The result file '" + filename + "' cannot be opened.";
+#ifdef _WIN32
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    throw std::runtime_error(error);
+  }
+  file_handle = file;
+  LARGE_INTEGER file_size;
+  GetFileSizeEx(file, &file_size);
+  size = file_size.QuadPart;
+  if (size > 0) {
+    mapping_handle =
+        CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_handle != nullptr) {
+      data = static_cast<const char*>(
+          MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    }
+  }
+#else
+  int file = open(filename.c_str(), O_RDONLY);
+  if (file < 0) {
+    throw std::runtime_error(error);
+  }
+  struct stat file_stat;
+  if (fstat(file, &file_stat) == 0) {
+    size = file_stat.st_size;
+  }
+  if (size > 0) {
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+    if (mapping != MAP_FAILED) {
+      data = static_cast<const char*>(mapping);
+    }
+  }
+  close(file);
+#endif
+  if (data == nullptr) {
+    unmap();
+    throw std::runtime_error(error);
+  }
+
+  // Read the header
+  size_t pos = 0;
+  auto check_size = [&](size_t count) {
+    if (pos + count > size) {
+      unmap();
+      throw std::runtime_error("The result file '" + filename +
+                               "' is incomplete.");
+    }
+  };
+  auto read = [&](void* value, size_t count) {
+    check_size(count);
+    std::memcpy(value, data + pos, count);
+    pos += count;
+  };
+  auto read_int = [&]() {
+    int32_t value;
+    read(&value, sizeof(value));
+    return value;
+  };
+  auto read_name = [&]() {
+    size_t length = std::max(read_int(), 0);
+    check_size(length);
+    std::string name(data + pos, length);
+    pos += length;
+    return name;
+  };
+
+  char magic[8];
+  read(magic, 8);
+  if ((std::memcmp(magic, "svZeroDC", 8) != 0) || (read_int() != 1)) {
+    unmap();
+    throw std::runtime_error("The file '" + filename +
+                             "' is not a svZeroDSolver result file.");
+  }
+  value_size = read_int();
+  int num_variables = read_int();
+  derivative = read_int() == 1;
+  read(&num_times, sizeof(num_times));
+  read(&data_offset, sizeof(data_offset));
+  for (int i = 0; i < num_variables; i++) {
+    variables.push_back(read_name());
+    variable_indices[variables.back()] = i;
+  }
+  int num_vessels = read_int();
+  for (int i = 0; i < num_vessels; i++) {
+    OutputEntry vessel;
+    vessel.name = read_name();
+    for (int j = 0; j < 4; j++) {
+      vessel.dofs.push_back(read_int());
+    }
+    vessels.push_back(vessel);
+  }
+
+  // Check the size of the data
+  size_t num_columns = derivative ? 2 * num_variables : num_variables;
+  if (data_offset + num_times * (sizeof(double) + num_columns * value_size) >
+      size) {
+    unmap();
+    throw std::runtime_error("The result file '" + filename +
+                             "' is incomplete.");
+  }
+}
+
+ResultReader::~ResultReader() { unmap(); }
+
+void ResultReader::unmap() {
+#ifdef _WIN32
+  if (data != nullptr) {
+    UnmapViewOfFile(data);
+  }
+  if (mapping_handle != nullptr) {
+    CloseHandle(mapping_handle);
+  }
+  if (file_handle != nullptr) {
+    CloseHandle(file_handle);
+  }
+  mapping_handle = nullptr;
+  file_handle = nullptr;
+#else
+  if (data != nullptr) {
+    munmap(const_cast<char*>(data), size);
+  }
+#endif
+  data = nullptr;
+}
+
+int64_t ResultReader::get_num_times() const { return num_times; }
+
+const std::vector<std::string>& ResultReader::get_variables() const {
+  return variables;
+}
+
+int ResultReader::get_variable_index(const std::string& name) const {
+  auto it = variable_indices.find(name);
+  if (it == variable_indices.end()) {
+    throw std::runtime_error("ERROR: Variable name '" + name +
+                             "' not found.");
+  }
+  return it->second;
+}
+
+const std::vector<OutputEntry>& ResultReader::get_vessels() const {
+  return vessels;
+}
+
+bool ResultReader::has_derivative() const { return derivative; }
+
+int ResultReader::get_value_size() const { return value_size; }
+
+const double* ResultReader::get_times() const {
+  return reinterpret_cast<const double*>(data + data_offset);
+}
+
+const void* ResultReader::get_data(bool derivative) const {
+  if (derivative && !this->derivative) {
+    throw std::runtime_error(
+        "The result file doesn't contain the time-derivatives.");
+  }
+  size_t offset = data_offset + num_times * sizeof(double);
+  if (derivative) {
+    offset += variables.size() * num_times * value_size;
+  }
+  return data + offset;
+}
+
+const void* ResultReader::get_column(int variable, bool derivative) const {
+  if ((variable < 0) || (variable >= int(variables.size()))) {
+    throw std::runtime_error("Variable index " + std::to_string(variable) +
+                             " is out of range.");
+  }
+  return static_cast<const char*>(get_data(derivative)) +
+         variable * num_times * value_size;
+}
@@ -0,0 +1,145 @@
+// SPDX-FileCopyrightText: Copyright (c) Stanford University, The Regents of the
+// University of California, and others. SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file ResultReader.h
+ * @brief ResultReader source file
+ */
+#ifndef SVZERODSOLVER_SOLVE_RESULTREADER_HPP_
+#define SVZERODSOLVER_SOLVE_RESULTREADER_HPP_
+
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "csv_writer.h"
+
+/**
+ * @brief Reader of a binary columnar result file (see ColumnarResultSink)
+ *
+ * The file is memory-mapped and the times and columns of the variables are
+ * returned as pointers into the mapping, i.e. without reading or copying the
+ * data. The pointers are valid as long as the reader exists.
+ */
+class ResultReader {
+ public:
+  /**
+   * @brief Map a result file and read its header
+   *
+   * Throws an error if the file is not a valid result file.
+   *
+   * @param filename Name of the result file
+   */
+  ResultReader(const std::string& filename);
+
+  /**
+   * @brief Unmap the result file
+   *
+   */
+  ~ResultReader();
+
+  ResultReader(const ResultReader&) = delete;
+  ResultReader& operator=(const ResultReader&) = delete;
+
+  /**
+   * @brief Get the number of time steps
+   *
+   * @return int64_t Number of time steps
+   */
+  int64_t get_num_times() const;
+
+  /**
+   * @brief Get the names of the variables
+   *
+   * @return const std::vector<std::string>& Names of the variables
+   */
+  const std::vector<std::string>& get_variables() const;
+
+  /**
+   * @brief Get the index of a variable
+   *
+   * @param name Name of the variable
+   * @return int Index of the variable
+   */
+  int get_variable_index(const std::string& name) const;
+
+  /**
+   * @brief Get the vessels with the indices of their inlet flow, outlet flow,
+   * inlet pressure and outlet pressure variables
+   *
+   * @return const std::vector<OutputEntry>& Vessels
+   */
+  const std::vector<OutputEntry>& get_vessels() const;
+
+  /**
+   * @brief Are the time-derivatives of the variables in the file?
+   *
+   * @return bool True if the time-derivatives are in the file
+   */
+  bool has_derivative() const;
+
+  /**
+   * @brief Get the size of the values in bytes (8: float64, 4: float32)
+   *
+   * @return int Size of the values
+   */
+  int get_value_size() const;
+
+  /**
+   * @brief Get the times
+   *
+   * @return const double* Times (get_num_times values)
+   */
+  const double* get_times() const;
+
+  /**
+   * @brief Get the time series of a variable
+   *
+   * Throws an error if the type doesn't match the size of the values in the
+   * file.
+   *
+   * @tparam T Type of the values (double or float)
+   * @param variable Index of the variable
+   * @param derivative Get the time-derivative instead of the variable
+   * @return const T* Values (get_num_times values)
+   */
+  template <typename T>
+  const T* get_values(int variable, bool derivative = false) const {
+    if (sizeof(T) != value_size) {
+      throw std::runtime_error("The values in the result file have " +
+                               std::to_string(value_size) + " bytes.");
+    }
+    return static_cast<const T*>(get_column(variable, derivative));
+  }
+
+  /**
+   * @brief Get the start of the values of all variables (one column of
+   * get_num_times values per variable)
+   *
+   * @param derivative Get the time-derivatives instead of the variables
+   * @return const void* Start of the values
+   */
+  const void* get_data(bool derivative = false) const;
+
+ private:
+  const char* data{nullptr};  ///< Start of the mapped file
+  size_t size{0};             ///< Size of the mapped file
+#ifdef _WIN32
+  void* file_handle{nullptr};
+  void* mapping_handle{nullptr};
+#endif
+
+  int value_size{8};
+  bool derivative{false};
+  int64_t num_times{0};
+  int64_t data_offset{0};
+  std::vector<std::string> variables;
+  std::map<std::string, int> variable_indices;
+  std::vector<OutputEntry> vessels;
+
+  const void* get_column(int variable, bool derivative) const;
+  void unmap();
+};
+
+#endif  // SVZERODSOLVER_SOLVE_RESULTREADER_HPP_
@@ -0,0 +1,504 @@
+// SPDX-FileCopyrightText: Copyright (c) Stanford University, The Regents of the
+// University of California, and others. SPDX-License-Identifier: BSD-3-Clause
+#include "ResultSink.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iomanip>
+#include <stdexcept>
+
+ResultSink::~ResultSink() {}
+
+void ResultSink::set_output_dofs(const std::vector<int>& dofs) {
+  output_dofs = dofs;
+}
+
+MemoryResultSink::MemoryResultSink(bool derivative) : derivative(derivative) {}
+
+void MemoryResultSink::begin(const Model& model, int num_outputs) {
+  dofs = output_dofs;
+  if (dofs.empty()) {
+    for (int i = 0; i < model.dofhandler.size(); i++) {
+      dofs.push_back(i);
+    }
+  }
+  dof_columns = std::vector<int>(model.dofhandler.size(), -1);
+  for (size_t i = 0; i < dofs.size(); i++) {
+    dof_columns[dofs[i]] = i;
+  }
+  row_size = derivative ? 2 * dofs.size() : dofs.size();
+
+  // Keep the buffers of a previous result
+  times.clear();
+  times.reserve(num_outputs);
+  values.clear();
+  values.reserve(num_outputs * row_size);
+}
+
+void MemoryResultSink::write(double time, const State& state) {
+  for (int dof : dofs) {
+    values.push_back(state.y[dof]);
+  }
+  if (derivative) {
+    for (int dof : dofs) {
+      values.push_back(state.ydot[dof]);
+    }
+  }
+  times.push_back(time);
+}
+
+void MemoryResultSink::end() {}
+
+const std::vector<double>& MemoryResultSink::get_times() const {
+  return times;
+}
+
+bool MemoryResultSink::has_dof(int dof) const {
+  return (dof >= 0) && (dof < int(dof_columns.size())) &&
+         (dof_columns[dof] >= 0);
+}
+
+ResultSpill::~ResultSpill() { remove(); }
+
+void ResultSpill::open(const std::string& filename, size_t num_values) {
+  this->filename = filename;
+  this->num_values = num_values;
+  file.open(filename, std::ios::in | std::ios::out | std::ios::trunc |
+                          std::ios::binary);
+  if (!file.is_open()) {
+    throw std::runtime_error("The temporary file '" + filename +
+                             "' cannot be opened.");
+  }
+}
+
+void ResultSpill::write(const double* values, size_t count) {
+  file.write(reinterpret_cast<const char*>(values), count * sizeof(double));
+}
+
+void ResultSpill::read_columns(size_t first, size_t last, size_t num_steps,
+                               std::vector<double>& columns) {
+  if (file.fail()) {
+    throw std::runtime_error("Writing the temporary file '" + filename +
+                             "' failed.");
+  }
+  file.flush();
+  file.seekg(0);
+
+  // Time steps read at once
+  size_t chunk_steps =
+      std::max(size_t(1), (size_t(1) << 20) / std::max(num_values, size_t(1)));
+  size_t num_columns = last - first;
+  columns.resize(num_columns * num_steps);
+  for (size_t step = 0; step < num_steps; step += chunk_steps) {
+    size_t steps = std::min(chunk_steps, num_steps - step);
+    chunk.resize(steps * num_values);
+    file.read(reinterpret_cast<char*>(chunk.data()),
+              chunk.size() * sizeof(double));
+    if (!file) {
+      throw std::runtime_error("Reading the temporary file '" + filename +
+                               "' failed.");
+    }
+    for (size_t i = 0; i < steps; i++) {
+      for (size_t j = 0; j < num_columns; j++) {
+        columns[j * num_steps + step + i] = chunk[i * num_values + first + j];
+      }
+    }
+  }
+}
+
+void ResultSpill::remove() {
+  if (file.is_open()) {
+    file.close();
+    std::remove(filename.c_str());
+  }
+}
+
+CsvResultSink::CsvResultSink(const std::string& filename, bool variable_based,
+                             bool mean, bool derivative, size_t buffer_size)
+    : filename(filename),
+      variable_based(variable_based),
+      mean(mean),
+      derivative(derivative),
+      buffer_size(buffer_size) {}
+
+CsvResultSink::~CsvResultSink() {
+  // The output file is only closed in end
+  if (out.is_open()) {
+    out.close();
+    std::remove(filename.c_str());
+  }
+}
+
+void CsvResultSink::begin(const Model& model, int num_outputs) {
+  entries = get_output_entries(model, variable_based, output_dofs);
+  entry_offsets.clear();
+  int num_values = 0;
+  for (auto& entry : entries) {
+    entry_offsets.push_back(num_values);
+    num_values += derivative ? 2 * entry.dofs.size() : entry.dofs.size();
+  }
+  values = std::vector<double>(num_values, 0.0);
+  times = std::vector<double>();
+  times.reserve(num_outputs);
+  num_steps = 0;
+
+  out.open(filename);
+  if (!out.is_open()) {
+    throw std::runtime_error("The output file '" + filename +
+                             "' cannot be opened.");
+  }
+  write_csv_header(out, variable_based, derivative);
+
+  if (!mean) {
+    spill.open(filename + ".spill", num_values);
+  }
+}
+
+void CsvResultSink::write(double time, const State& state) {
+  for (size_t i = 0; i < entries.size(); i++) {
+    auto& dofs = entries[i].dofs;
+    double* entry_values = values.data() + entry_offsets[i];
+    for (size_t j = 0; j < dofs.size(); j++) {
+      if (mean) {
+        entry_values[j] += state.y[dofs[j]];
+      } else {
+        entry_values[j] = state.y[dofs[j]];
+      }
+    }
+    if (derivative) {
+      entry_values += dofs.size();
+      for (size_t j = 0; j < dofs.size(); j++) {
+        if (mean) {
+          entry_values[j] += state.ydot[dofs[j]];
+        } else {
+          entry_values[j] = state.ydot[dofs[j]];
+        }
+      }
+    }
+  }
+  if (!mean) {
+    spill.write(values.data(), values.size());
+    times.push_back(time);
+  }
+  num_steps++;
+}
+
+void CsvResultSink::end() {
+  if (mean) {
+    for (size_t i = 0; i < entries.size(); i++) {
+      int num_values = derivative ? 2 * entries[i].dofs.size()
+                                  : entries[i].dofs.size();
+      auto entry_values = values.begin() + entry_offsets[i];
+      std::vector<double> means(entry_values, entry_values + num_values);
+      for (auto& mean_value : means) {
+        mean_value /= num_steps;
+      }
+      write_csv_mean_row(out, entries[i].name, means);
+    }
+  } else {
+    // Transpose the spilled values into the rows of one group of entries
+    // after another (each group fits into the buffer)
+    size_t num_values = values.size();
+    size_t num_times = times.size();
+    auto end_value = [&](size_t entry) -> size_t {
+      return (entry + 1 < entries.size()) ? entry_offsets[entry + 1]
+                                          : num_values;
+    };
+    std::vector<double> columns;
+    size_t entry = 0;
+    while (entry < entries.size()) {
+      size_t first_entry = entry;
+      size_t first_value = entry_offsets[entry];
+      entry++;
+      while ((entry < entries.size()) &&
+             ((end_value(entry) - first_value) * num_times * sizeof(double) <=
+              buffer_size)) {
+        entry++;
+      }
+      spill.read_columns(first_value, end_value(entry - 1), num_times,
+                         columns);
+
+      for (size_t i = first_entry; i < entry; i++) {
+        const double* entry_columns =
+            columns.data() + (entry_offsets[i] - first_value) * num_times;
+        int num_entry_values = end_value(i) - entry_offsets[i];
+        write_csv_rows(out, entries[i].name, times, num_entry_values,
+                       [&](int step, int index) {
+                         return entry_columns[index * num_times + step];
+                       });
+      }
+    }
+    spill.remove();
+  }
+
+  out.close();
+  if (out.fail()) {
+    throw std::runtime_error("Writing the output file '" + filename +
+                             "' failed.");
+  }
+}
+
+ColumnarResultSink::ColumnarResultSink(const std::string& filename,
+                                       bool derivative, bool single_precision,
+                                       size_t buffer_size)
+    : filename(filename),
+      derivative(derivative),
+      single_precision(single_precision),
+      buffer_size(buffer_size) {}
+
+ColumnarResultSink::~ColumnarResultSink() {
+  // The output file is only open while it is written in end
+  if (out.is_open()) {
+    out.close();
+    std::remove(filename.c_str());
+  }
+}
+
+void ColumnarResultSink::begin(const Model& model, int num_outputs) {
+  dofs = output_dofs;
+  if (dofs.empty()) {
+    for (int i = 0; i < model.dofhandler.size(); i++) {
+      dofs.push_back(i);
+    }
+  }
+  variables.clear();
+  std::vector<int> dof_variables(model.dofhandler.size(), -1);
+  for (size_t i = 0; i < dofs.size(); i++) {
+    variables.push_back(model.dofhandler.variables[dofs[i]]);
+    dof_variables[dofs[i]] = i;
+  }
+
+  // Vessels with the indices of their variables in the file
+  vessels = get_output_entries(model, false, dofs);
+  for (auto& vessel : vessels) {
+    for (auto& dof : vessel.dofs) {
+      dof = dof_variables[dof];
+    }
+  }
+
+  times = std::vector<double>();
+  times.reserve(num_outputs);
+  values = std::vector<double>(derivative ? 2 * dofs.size() : dofs.size());
+  spill.open(filename + ".spill", values.size());
+}
+
+void ColumnarResultSink::write(double time, const State& state) {
+  for (size_t i = 0; i < dofs.size(); i++) {
+    values[i] = state.y[dofs[i]];
+  }
+  if (derivative) {
+    for (size_t i = 0; i < dofs.size(); i++) {
+      values[dofs.size() + i] = state.ydot[dofs[i]];
+    }
+  }
+  spill.write(values.data(), values.size());
+  times.push_back(time);
+}
+
+void ColumnarResultSink::end() {
+  out.open(filename, std::ios::binary);
+  if (!out.is_open()) {
+    throw std::runtime_error("The output file '" + filename +
+                             "' cannot be opened.");
+  }
+  auto write_int = [&](int32_t value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  };
+  auto write_name = [&](const std::string& name) {
+    write_int(name.size());
+    out.write(name.data(), name.size());
+  };
+
+  // Header (with the offset of the data written at the end)
+  int64_t num_times = times.size();
+  out.write("svZeroDC", 8);
+  write_int(1);
+  write_int(single_precision ? sizeof(float) : sizeof(double));
+  write_int(variables.size());
+  write_int(derivative ? 1 : 0);
+  out.write(reinterpret_cast<const char*>(&num_times), sizeof(num_times));
+  auto data_offset_pos = out.tellp();
+  int64_t data_offset = 0;
+  out.write(reinterpret_cast<const char*>(&data_offset), sizeof(data_offset));
+  for (auto& name : variables) {
+    write_name(name);
+  }
+  write_int(vessels.size());
+  for (auto& vessel : vessels) {
+    write_name(vessel.name);
+    for (int dof : vessel.dofs) {
+      write_int(dof);
+    }
+  }
+  data_offset = (int64_t(out.tellp()) + 63) / 64 * 64;
+  while (out.tellp() < data_offset) {
+    out.put(0);
+  }
+  out.seekp(data_offset_pos);
+  out.write(reinterpret_cast<const char*>(&data_offset), sizeof(data_offset));
+  out.seekp(data_offset);
+
+  // Times and columns (transposed from the spill file in groups of columns
+  // that fit into the buffer)
+  out.write(reinterpret_cast<const char*>(times.data()),
+            times.size() * sizeof(double));
+  size_t num_values = values.size();
+  size_t column_size = std::max(size_t(num_times), size_t(1)) * sizeof(double);
+  size_t group_size = std::max(size_t(1), buffer_size / column_size);
+  std::vector<double> columns;
+  std::vector<float> float_columns;
+  for (size_t first = 0; first < num_values; first += group_size) {
+    size_t last = std::min(first + group_size, num_values);
+    spill.read_columns(first, last, num_times, columns);
+    if (single_precision) {
+      float_columns.assign(columns.begin(), columns.end());
+      out.write(reinterpret_cast<const char*>(float_columns.data()),
+                float_columns.size() * sizeof(float));
+    } else {
+      out.write(reinterpret_cast<const char*>(columns.data()),
+                columns.size() * sizeof(double));
+    }
+  }
+  spill.remove();
+
+  out.close();
+  if (out.fail()) {
+    throw std::runtime_error("Writing the output file '" + filename +
+                             "' failed.");
+  }
+}
+
+StatisticsResultSink::StatisticsResultSink(
+    const std::string& filename, const std::vector<std::string>& statistics,
+    bool per_cycle)
+    : filename(filename),
+      statistics(statistics),
+      per_cycle(per_cycle),
+      out(&file) {}
+
+StatisticsResultSink::StatisticsResultSink(
+    std::ostream& out, const std::vector<std::string>& statistics,
+    bool per_cycle)
+    : statistics(statistics), per_cycle(per_cycle), out(&out) {}
+
+void StatisticsResultSink::begin(const Model& model,
+                                 [[maybe_unused]] int num_outputs) {
+  dofs = output_dofs;
+  if (dofs.empty()) {
+    for (int i = 0; i < model.dofhandler.size(); i++) {
+      dofs.push_back(i);
+    }
+  }
+  variables.clear();
+  for (int dof : dofs) {
+    variables.push_back(model.dofhandler.variables[dof]);
+  }
+  period = model.cardiac_cycle_period;
+  cycle = 0;
+  num_steps = 0;
+  sums = std::vector<double>(dofs.size(), 0.0);
+  sums_of_squares = std::vector<double>(dofs.size(), 0.0);
+  minima = std::vector<double>(dofs.size(), 0.0);
+  maxima = std::vector<double>(dofs.size(), 0.0);
+
+  if (!filename.empty()) {
+    file.open(filename);
+    if (!file.is_open()) {
+      throw std::runtime_error("The output file '" + filename +
+                               "' cannot be opened.");
+    }
+  }
+  *out << std::scientific << std::setprecision(16);
+  *out << "name";
+  if (per_cycle) {
+    *out << ",cycle";
+  }
+  for (auto& statistic : statistics) {
+    *out << "," << statistic;
+  }
+  *out << "\n";
+}
+
+void StatisticsResultSink::write(double time, const State& state) {
+  if (per_cycle && (period > 0.0)) {
+    // Cycle of the time step (the one it ends if it is at the end of a cycle)
+    double cycles = time / period;
+    int time_cycle = std::max(int(std::ceil(cycles - 1.0e-8)) - 1, 0);
+    if (time_cycle > cycle) {
+      write_statistics();
+      cycle = time_cycle;
+    }
+    add(state);
+
+    // A time step at the end of the cycle also starts the next cycle
+    if (std::abs(cycles - (cycle + 1)) < 1.0e-8) {
+      write_statistics();
+      cycle++;
+      add(state);
+    }
+  } else {
+    add(state);
+  }
+}
+
+void StatisticsResultSink::end() {
+  // Skip a last cycle that only consists of the end of the previous cycle
+  if ((num_steps > 1) || (!per_cycle && (num_steps > 0)) ||
+      ((num_steps == 1) && (cycle == 0))) {
+    write_statistics();
+  }
+
+  if (!filename.empty()) {
+    file.close();
+    if (file.fail()) {
+      throw std::runtime_error("Writing the output file '" + filename +
+                               "' failed.");
+    }
+  }
+}
+
+void StatisticsResultSink::add(const State& state) {
+  for (size_t i = 0; i < dofs.size(); i++) {
+    double value = state.y[dofs[i]];
+    sums[i] += value;
+    sums_of_squares[i] += value * value;
+    if ((num_steps == 0) || (value < minima[i])) {
+      minima[i] = value;
+    }
+    if ((num_steps == 0) || (value > maxima[i])) {
+      maxima[i] = value;
+    }
+  }
+  num_steps++;
+}
+
+void StatisticsResultSink::write_statistics() {
+  for (size_t i = 0; i < dofs.size(); i++) {
+    *out << variables[i];
+    if (per_cycle) {
+      *out << "," << cycle;
+    }
+    for (auto& statistic : statistics) {
+      double value = 0.0;
+      if (statistic == "mean") {
+        value = sums[i] / num_steps;
+      } else if (statistic == "min") {
+        value = minima[i];
+      } else if (statistic == "max") {
+        value = maxima[i];
+      } else if (statistic == "rms") {
+        value = std::sqrt(sums_of_squares[i] / num_steps);
+      } else {
+        value = maxima[i] - minima[i];
+      }
+      *out << "," << value;
+    }
+    *out << "\n";
+  }
+
+  std::fill(sums.begin(), sums.end(), 0.0);
+  std::fill(sums_of_squares.begin(), sums_of_squares.end(), 0.0);
+  num_steps = 0;
+}
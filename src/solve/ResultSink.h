@@ -0,0 +1,400 @@
+// SPDX-FileCopyrightText: Copyright (c) Stanford University, The Regents of the
+// University of California, and others. SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file ResultSink.h
+ * @brief ResultSink source file
+ */
+#ifndef SVZERODSOLVER_SOLVE_RESULTSINK_HPP_
+#define SVZERODSOLVER_SOLVE_RESULTSINK_HPP_
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Model.h"
+#include "State.h"
+#include "csv_writer.h"
+
+/**
+ * @brief Receiver of the output time steps of a simulation
+ *
+ * The solver passes each output time and state to the sink as soon as it is
+ * computed (see Solver::run), such that a sink can write the result while
+ * integrating instead of keeping every state in memory.
+ */
+class ResultSink {
+ public:
+  /**
+   * @brief Destroy the Result Sink object
+   *
+   */
+  virtual ~ResultSink();
+
+  /**
+   * @brief Start a new result
+   *
+   * @param model The underlying model
+   * @param num_outputs Expected number of output time steps (can be exceeded,
+   * e.g. with the cardiac cycles simulated until convergence)
+   */
+  virtual void begin(const Model& model, int num_outputs) = 0;
+
+  /**
+   * @brief Add an output time step
+   *
+   * @param time Time of the output
+   * @param state State at the time of the output
+   */
+  virtual void write(double time, const State& state) = 0;
+
+  /**
+   * @brief Complete the result after the last output time step
+   *
+   */
+  virtual void end() = 0;
+
+  /**
+   * @brief Restrict the result to a subset of the degrees-of-freedom (e.g.
+   * those selected with select_output_dofs)
+   *
+   * @param dofs Degrees-of-freedom in the result (all if empty)
+   */
+  void set_output_dofs(const std::vector<int>& dofs);
+
+ protected:
+  std::vector<int> output_dofs;  ///< Degrees-of-freedom in the result (all if
+                                 ///< empty)
+};
+
+/**
+ * @brief Result sink that keeps the output in memory
+ *
+ * Only the values of the degrees-of-freedom in the result (see
+ * set_output_dofs) are kept, in a contiguous time-by-variable buffer with one
+ * row per time step. The buffer is preallocated in begin, such that the time
+ * loop doesn't allocate it.
+ */
+class MemoryResultSink : public ResultSink {
+ public:
+  /**
+   * @brief Construct a new Memory Result Sink object
+   *
+   * @param derivative Toggle whether to keep the time-derivatives
+   */
+  MemoryResultSink(bool derivative = false);
+
+  void begin(const Model& model, int num_outputs) override;
+  void write(double time, const State& state) override;
+  void end() override;
+
+  /**
+   * @brief Get the times of the output time steps
+   *
+   * @return const std::vector<double>& Times
+   */
+  const std::vector<double>& get_times() const;
+
+  /**
+   * @brief Check if a degree-of-freedom is kept
+   *
+   * @param dof Degree-of-freedom
+   * @return bool True if the degree-of-freedom is kept
+   */
+  bool has_dof(int dof) const;
+
+  /**
+   * @brief Get the value of a degree-of-freedom at an output time step
+   *
+   * @param step Index of the output time step
+   * @param dof Degree-of-freedom (see has_dof)
+   * @param derivative Get the time-derivative instead of the solution
+   * @return double Value
+   */
+  double get_value(size_t step, int dof, bool derivative = false) const {
+    int column = dof_columns[dof];
+    if (derivative) {
+      column += dofs.size();
+    }
+    return values[step * row_size + column];
+  }
+
+ private:
+  bool derivative;
+  std::vector<int> dofs;         ///< Degrees-of-freedom that are kept
+  std::vector<int> dof_columns;  ///< Column of each degree-of-freedom (-1 if
+                                 ///< not kept)
+  size_t row_size{0};            ///< Number of values per time step
+  std::vector<double> times;
+  std::vector<double> values;
+};
+
+/**
+ * @brief Temporary file with the values of the output time steps
+ *
+ * The values of each time step are appended as a row while integrating and
+ * read back by column, i.e. one group of values over all time steps at a
+ * time (e.g. to write the output of one vessel or variable after another).
+ */
+class ResultSpill {
+ public:
+  /**
+   * @brief Destroy the Result Spill object
+   *
+   * Deletes the temporary file if it wasn't removed (e.g. if the simulation
+   * failed).
+   */
+  ~ResultSpill();
+
+  /**
+   * @brief Create the temporary file
+   *
+   * @param filename Name of the temporary file
+   * @param num_values Number of values per time step
+   */
+  void open(const std::string& filename, size_t num_values);
+
+  /**
+   * @brief Append values to the current time step
+   *
+   * @param values Values
+   * @param count Number of values
+   */
+  void write(const double* values, size_t count);
+
+  /**
+   * @brief Read a range of values over all time steps
+   *
+   * @param first Index of the first value
+   * @param last Index after the last value
+   * @param num_steps Number of time steps
+   * @param columns The values (column `i` at `i * num_steps`)
+   */
+  void read_columns(size_t first, size_t last, size_t num_steps,
+                    std::vector<double>& columns);
+
+  /**
+   * @brief Close and delete the temporary file (if it is open)
+   *
+   */
+  void remove();
+
+ private:
+  std::string filename;
+  size_t num_values{0};
+  std::fstream file;
+  std::vector<double> chunk;
+};
+
+/**
+ * @brief Result sink that writes the csv output (see write_csv) to a file
+ *
+ * The csv output lists all time steps of a vessel or variable before the
+ * next one. The values needed for the output (and nothing else of the
+ * states) are therefore written to a temporary spill file next to the output
+ * file while integrating, which is transposed into the csv file in end. The
+ * transposition reads the spill file once for each group of names whose
+ * values fit into the buffer.
+ *
+ * With only the mean values, the sums of the values are accumulated instead.
+ *
+ * If the result is not completed (e.g. because the simulation failed), the
+ * incomplete csv file is deleted with the sink.
+ */
+class CsvResultSink : public ResultSink {
+ public:
+  /**
+   * @brief Construct a new Csv Result Sink object
+   *
+   * @param filename Name of the csv file
+   * @param variable_based Toggle variable based (instead of vessel based)
+   * output
+   * @param mean Toggle whether only the mean over all time steps should be
+   * written
+   * @param derivative Toggle whether to output time-derivatives
+   * @param buffer_size Size of the transposition buffer in bytes
+   */
+  CsvResultSink(const std::string& filename, bool variable_based,
+                bool mean = false, bool derivative = false,
+                size_t buffer_size = 256 << 20);
+
+  /**
+   * @brief Destroy the Csv Result Sink object
+   *
+   */
+  ~CsvResultSink();
+
+  void begin(const Model& model, int num_outputs) override;
+  void write(double time, const State& state) override;
+  void end() override;
+
+ private:
+  std::string filename;
+  bool variable_based;
+  bool mean;
+  bool derivative;
+  size_t buffer_size;
+
+  std::ofstream out;
+  ResultSpill spill;
+  std::vector<OutputEntry> entries;
+  std::vector<int> entry_offsets;  ///< Index of the first value of an entry
+  std::vector<double> times;
+  std::vector<double> values;  ///< Values of a time step (or their sums)
+  int num_steps{0};
+};
+
+/**
+ * @brief Result sink that writes the output states to a binary columnar file
+ *
+ * The file holds the names of the variables, the degrees-of-freedom of the
+ * vessels, the times and then the time series of each variable as a
+ * contiguous column, such that it can be memory-mapped and used without
+ * parsing (see ResultReader). As in CsvResultSink, the states are spilled to
+ * a temporary file while integrating and transposed into the columns in end.
+ *
+ * All numbers are in the native byte order (little endian on all supported
+ * platforms). The file starts with a header:
+ *
+ * - magic string `svZeroDC` (8 characters)
+ * - format version (int32, 1)
+ * - size of the values in bytes (int32, 8: float64, 4: float32)
+ * - number of variables `n` (int32)
+ * - 1 if the time-derivatives are included, 0 otherwise (int32)
+ * - number of time steps `m` (int64)
+ * - offset of the data from the start of the file (int64, multiple of 64)
+ * - `n` variable names (see DOFHandler::variables, only those of the
+ *   degrees-of-freedom in the result), each as its length (int32) followed by
+ *   the characters
+ * - number of vessels (int32), each with its name (as the variable names)
+ *   and the inlet flow, outlet flow, inlet pressure and outlet pressure
+ *   variable indices (4 x int32, into the variables of the file)
+ *
+ * The data consists of the `m` times (float64), the `m` values of `y` of
+ * each variable and (optionally) the `m` values of `ydot` of each variable.
+ *
+ * If the result is not completed (e.g. because the simulation failed), the
+ * spill file and an incomplete binary file are deleted with the sink.
+ */
+class ColumnarResultSink : public ResultSink {
+ public:
+  /**
+   * @brief Construct a new Columnar Result Sink object
+   *
+   * @param filename Name of the binary file
+   * @param derivative Toggle whether to output time-derivatives
+   * @param single_precision Toggle whether to write the values as float32
+   * (the times are always float64)
+   * @param buffer_size Size of the transposition buffer in bytes
+   */
+  ColumnarResultSink(const std::string& filename, bool derivative = false,
+                     bool single_precision = false,
+                     size_t buffer_size = 256 << 20);
+
+  /**
+   * @brief Destroy the Columnar Result Sink object
+   *
+   */
+  ~ColumnarResultSink();
+
+  void begin(const Model& model, int num_outputs) override;
+  void write(double time, const State& state) override;
+  void end() override;
+
+ private:
+  std::string filename;
+  bool derivative;
+  bool single_precision;
+  size_t buffer_size;
+
+  std::ofstream out;
+  ResultSpill spill;
+  std::vector<int> dofs;  ///< Degrees-of-freedom of the variables
+  std::vector<std::string> variables;
+  std::vector<OutputEntry> vessels;
+  std::vector<double> times;
+  std::vector<double> values;  ///< Values of a time step
+};
+
+/**
+ * @brief Result sink that writes statistics of the variables to a csv file
+ * (or stream)
+ *
+ * Running sums, minima and maxima of the variables are updated with each
+ * output time step, such that the memory doesn't depend on the number of time
+ * steps. The statistics are either those of all output time steps or those of
+ * each cardiac cycle, which are written as soon as the cycle is complete. The
+ * time step at the end of a cycle belongs to both the cycle it ends and the
+ * cycle it starts.
+ *
+ * The csv file has one row per variable (and cycle) with the columns `name`,
+ * `cycle` (index of the cycle in the output, only per cycle) and the
+ * statistics in the given order:
+ *
+ * - `mean`: mean value
+ * - `min`: minimum (e.g. diastolic pressure)
+ * - `max`: maximum (e.g. systolic pressure)
+ * - `rms`: root mean square
+ * - `amplitude`: maximum - minimum (e.g. pulse pressure)
+ */
+class StatisticsResultSink : public ResultSink {
+ public:
+  /**
+   * @brief Construct a new Statistics Result Sink object
+   *
+   * @param filename Name of the csv file
+   * @param statistics Names of the statistics (validated in
+   * load_simulation_params)
+   * @param per_cycle Toggle whether to write the statistics of each cardiac
+   * cycle (instead of all output time steps)
+   */
+  StatisticsResultSink(const std::string& filename,
+                       const std::vector<std::string>& statistics,
+                       bool per_cycle = false);
+
+  /**
+   * @brief Construct a new Statistics Result Sink object that writes to a
+   * stream instead of a file
+   *
+   * @param out Output stream
+   * @param statistics Names of the statistics (validated in
+   * load_simulation_params)
+   * @param per_cycle Toggle whether to write the statistics of each cardiac
+   * cycle (instead of all output time steps)
+   */
+  StatisticsResultSink(std::ostream& out,
+                       const std::vector<std::string>& statistics,
+                       bool per_cycle = false);
+
+  void begin(const Model& model, int num_outputs) override;
+  void write(double time, const State& state) override;
+  void end() override;
+
+ private:
+  std::string filename;  ///< Name of the csv file (empty for a stream)
+  std::vector<std::string> statistics;
+  bool per_cycle;
+
+  std::ofstream file;
+  std::ostream* out;      ///< The csv file or the given stream
+  std::vector<int> dofs;  ///< Degrees-of-freedom of the variables
+  std::vector<std::string> variables;
+  double period{0.0};  ///< Cardiac cycle period
+  int cycle{0};        ///< Index of the current cycle
+  int num_steps{0};    ///< Number of time steps in the statistics
+  std::vector<double> sums;
+  std::vector<double> sums_of_squares;
+  std::vector<double> minima;
+  std::vector<double> maxima;
+
+  /**
+   * @brief Add the values of a time step to the statistics
+   *
+   * @param state State of the time step
+   */
+  void add(const State& state);
+
+  /// Write the rows of the statistics and reset them
+  void write_statistics();
+};
+
+#endif  // SVZERODSOLVER_SOLVE_RESULTSINK_HPP_
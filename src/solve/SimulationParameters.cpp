@@ -226,7 +226,31 @@ SimulationParameters load_simulation_params(const nlohmann::json& config) {
              2);  // need at least two cycles to compute cycle-to-cycle error
       sim_params.sim_cycle_to_cycle_error =
           sim_config.value("sim_cycle_to_cycle_percent_error", 1.0) / 100;
+      sim_params.sim_cycle_acceleration =
+          sim_config.value("cycle_to_cycle_acceleration", "none");
+      sim_params.sim_cycle_acceleration_memory =
+          sim_config.value("cycle_to_cycle_acceleration_memory", 3);
+      if ((sim_params.sim_cycle_acceleration != "none") &&
+          (sim_params.sim_cycle_acceleration != "anderson") &&
+          (sim_params.sim_cycle_acceleration != "aitken")) {
+        throw std::runtime_error("Invalid cycle-to-cycle acceleration " +
+                                 sim_params.sim_cycle_acceleration);
+      }
     }
+    sim_params.sim_periodic_steady_state =
+        sim_config.value("periodic_steady_state", false);
+    sim_params.sim_periodic_steady_state_tol =
+        sim_config.value("periodic_steady_state_tolerance", 1.0e-6);
+    sim_params.sim_periodic_steady_state_max_iter =
+        sim_config.value("periodic_steady_state_max_iterations", 20);
+    sim_params.sim_adaptive_time_stepping =
+        sim_config.value("adaptive_time_stepping", false);
+    sim_params.sim_adaptive_tol =
+        sim_config.value("adaptive_time_step_tolerance", 1.0e-3);
+    sim_params.sim_min_time_step_size =
+        sim_config.value("minimum_time_step_size", 0.0);
+    sim_params.sim_max_time_step_size =
+        sim_config.value("maximum_time_step_size", 0.0);
     sim_params.sim_external_step_size = 0.0;
   } else {
     sim_params.sim_num_cycles = 1;
@@ -235,16 +259,71 @@ SimulationParameters load_simulation_params(const nlohmann::json& config) {
     sim_params.sim_external_step_size =
         sim_config.value("external_step_size", 0.1);
   }
+  sim_params.sim_integrator =
+      sim_config.value("integrator", "generalized_alpha");
+  if ((sim_params.sim_integrator != "generalized_alpha") &&
+      (sim_params.sim_integrator != "rosenbrock")) {
+    throw std::runtime_error("Invalid integrator " + sim_params.sim_integrator +
+                             ". Options are generalized_alpha, rosenbrock.");
+  }
   sim_params.sim_abs_tol = sim_config.value("absolute_tolerance", 1e-8);
   sim_params.sim_nliter = sim_config.value("maximum_nonlinear_iterations", 30);
   sim_params.sim_steady_initial = sim_config.value("steady_initial", true);
   sim_params.sim_rho_infty = sim_config.value("rho_infty", 0.5);
+  sim_params.linear_solver = sim_config.value("linear_solver", "sparse_lu");
+  sim_params.linear_solver_ordering =
+      sim_config.value("linear_solver_ordering", "colamd");
+  sim_params.sim_jacobian_reuse_steps =
+      sim_config.value("jacobian_reuse_steps", 0);
+  sim_params.sim_jacobian_reuse_rate =
+      sim_config.value("jacobian_reuse_rate", 0.5);
+  sim_params.sim_event_detection = sim_config.value("event_detection", false);
+  sim_params.sim_line_search = sim_config.value("nonlinear_line_search", false);
+  sim_params.sim_max_step_halvings =
+      sim_config.value("maximum_time_step_halvings", 0);
+  sim_params.sim_predictor = sim_config.value("predictor", "constant");
+  std::string interpolation =
+      sim_config.value("parameter_interpolation", "linear");
+  if (interpolation == "linear") {
+    sim_params.sim_parameter_interpolation = InterpolationMethod::linear;
+  } else if (interpolation == "cubic_spline") {
+    sim_params.sim_parameter_interpolation = InterpolationMethod::cubic_spline;
+  } else {
+    throw std::runtime_error("Invalid parameter interpolation " +
+                             interpolation);
+  }
+  sim_params.sim_parameter_resampling_points =
+      sim_config.value("parameter_resampling_points", 0);
   sim_params.output_variable_based =
       sim_config.value("output_variable_based", false);
   sim_params.output_interval = sim_config.value("output_interval", 1);
   sim_params.output_mean_only = sim_config.value("output_mean_only", false);
   sim_params.output_derivative = sim_config.value("output_derivative", false);
   sim_params.output_all_cycles = sim_config.value("output_all_cycles", false);
+  sim_params.output_format = sim_config.value("output_format", "csv");
+  if ((sim_params.output_format != "csv") &&
+      (sim_params.output_format != "binary")) {
+    throw std::runtime_error("Invalid output format " +
+                             sim_params.output_format +
+                             ". Options are csv, binary.");
+  }
+  sim_params.output_single_precision =
+      sim_config.value("output_single_precision", false);
+  sim_params.output_variables = sim_config.value(
+      "output_variables", std::vector<std::string>());
+  sim_params.output_statistics = sim_config.value(
+      "output_statistics", std::vector<std::string>());
+  for (auto& statistic : sim_params.output_statistics) {
+    if ((statistic != "mean") && (statistic != "min") &&
+        (statistic != "max") && (statistic != "rms") &&
+        (statistic != "amplitude")) {
+      throw std::runtime_error("Invalid output statistic " + statistic +
+                               ". Options are mean, min, max, rms, "
+                               "amplitude.");
+    }
+  }
+  sim_params.output_statistics_per_cycle =
+      sim_config.value("output_statistics_per_cycle", false);
   sim_params.sim_cardiac_period = sim_config.value("cardiac_period", -1.0);
   DEBUG_MSG("Finished loading simulation parameters");
   return sim_params;
@@ -11,6 +11,7 @@
 #include <nlohmann/json.hpp>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "ActivationFunction.h"
 #include "Model.h"
@@ -50,10 +51,69 @@ struct SimulationParameters {
                ///< cycles to simulate to be value estimated from equation 21 of
                ///< Pfaller 2021
   double sim_cycle_to_cycle_error{0};  ///< Cycle-to-cycle error
+  std::string sim_cycle_acceleration{
+      "none"};  ///< Acceleration of the cycle-to-cycle convergence (`none`,
+                ///< `anderson`, `aitken`; models with RCR boundary
+                ///< conditions are then also simulated to convergence)
+  int sim_cycle_acceleration_memory{
+      3};  ///< Number of previous cycles used by Anderson acceleration
+  bool sim_periodic_steady_state{
+      false};  ///< Find the periodic steady state with a Newton-Krylov
+               ///< shooting method and simulate a single cardiac cycle
+  double sim_periodic_steady_state_tol{
+      1.0e-6};  ///< Tolerance of the scaled difference between the start and
+                ///< end of the cardiac cycle in the periodic steady state
+  int sim_periodic_steady_state_max_iter{
+      20};  ///< Maximum number of Newton iterations of the shooting method
+  std::string sim_integrator{
+      "generalized_alpha"};  ///< Time integrator (`generalized_alpha`,
+                             ///< `rosenbrock`)
+  bool sim_adaptive_time_stepping{
+      false};  ///< Adapt the time step size to an estimate of the local
+               ///< truncation error (the output is interpolated at the time
+               ///< steps given by the number of time points per cycle)
+  double sim_adaptive_tol{
+      1.0e-3};  ///< Tolerance of the scaled local truncation error
+  bool sim_embedded_error_control{
+      false};  ///< Split the time steps of the Rosenbrock integrator into
+               ///< sub-steps controlled by its embedded error estimate (set
+               ///< instead of adaptive time stepping)
+  double sim_min_time_step_size{0.0};  ///< Minimum adaptive time step size
+                                       ///< (0: 1/100 of the time step size)
+  double sim_max_time_step_size{0.0};  ///< Maximum adaptive time step size
+                                       ///< (0: 1/50 of the cardiac cycle)
   int sim_num_time_steps{0};           ///< Total number of time steps
   int sim_nliter{0};  ///< Maximum number of non-linear iterations in time
                       ///< integration
   double sim_rho_infty{0.0};  ///< Spectral radius of generalized-alpha
+  std::string linear_solver{"sparse_lu"};  ///< Linear solver (`sparse_lu`,
+                                           ///< `sparse_qr`, `dense_lu`, `klu`,
+                                           ///< only the last two don't
+                                           ///< allocate in each time step)
+  std::string linear_solver_ordering{
+      "colamd"};  ///< Fill-reducing column ordering of the linear solver
+                  ///< (`colamd`, `amd`, `natural`)
+  int sim_jacobian_reuse_steps{0};  ///< Maximum number of time steps in which
+                                    ///< a factorization of the Jacobian is
+                                    ///< reused (0: no reuse)
+  double sim_jacobian_reuse_rate{0.5};  ///< Maximum residual ratio of two
+                                        ///< non-linear iterations with a
+                                        ///< reused factorization
+  bool sim_event_detection{false};  ///< Split the time steps at the switches
+                                    ///< of valves (see Integrator::step)
+  bool sim_line_search{false};  ///< Damp the non-linear increments with a
+                                ///< backtracking line search
+  int sim_max_step_halvings{0};  ///< Maximum number of times a time step is
+                                 ///< halved if the non-linear iterations fail
+  std::string sim_predictor{
+      "constant"};  ///< Predictor of the non-linear iterations (`constant`,
+                    ///< `extrapolate2`, `extrapolate3`, `periodic`)
+  InterpolationMethod sim_parameter_interpolation{
+      InterpolationMethod::linear};  ///< Interpolation of the time-dependent
+                                     ///< parameters
+  int sim_parameter_resampling_points{0};  ///< Number of points the
+                                           ///< time-dependent parameters are
+                                           ///< resampled to (0: no resampling)
   int output_interval{0};     ///< Interval of writing output
 
   bool sim_steady_initial{0};  ///< Start from steady solution
@@ -62,6 +122,21 @@ struct SimulationParameters {
   bool output_mean_only{false};   ///< Output only the mean value
   bool output_derivative{false};  ///< Output derivatives
   bool output_all_cycles{false};  ///< Output all cardiac cycles
+  std::string output_format{
+      "csv"};  ///< Format of the output file (`csv`, `binary`: columnar file
+               ///< that can be memory-mapped, see ColumnarResultSink)
+  bool output_single_precision{
+      false};  ///< Write the values of the binary output as float32
+  std::vector<std::string>
+      output_variables;  ///< Names of the variables in the output, which may
+                         ///< contain the wildcards `*` and `?` (all if empty,
+                         ///< see select_output_dofs)
+  std::vector<std::string>
+      output_statistics;  ///< Statistics of the variables written instead of
+                          ///< their time series (`mean`, `min`, `max`,
+                          ///< `rms`, `amplitude`, see StatisticsResultSink)
+  bool output_statistics_per_cycle{
+      false};  ///< Write the statistics of each cardiac cycle
 
   bool sim_coupled{
       false};  ///< Running 0D simulation coupled with external solver
@@ -3,6 +3,19 @@
 
 #include "Solver.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <thread>
+
+#include "AndersonAcceleration.h"
+#include "allocation_counter.h"
 #include "csv_writer.h"
 
 Solver::Solver(const nlohmann::json& config) {
@@ -12,6 +25,9 @@ Solver::Solver(const nlohmann::json& config) {
   DEBUG_MSG("Load model");
   this->model = std::shared_ptr<Model>(new Model());
   load_simulation_model(config, *this->model.get());
+  this->model->set_parameter_interpolation(
+      simparams.sim_parameter_interpolation,
+      simparams.sim_parameter_resampling_points);
 
   // If period isn't specified anywhere, set to 1
   if (simparams.sim_cardiac_period < 0 &&
@@ -33,8 +49,11 @@ Solver::Solver(const nlohmann::json& config) {
 
   DEBUG_MSG("Cardiac cycle period " << this->model->cardiac_cycle_period);
 
+  // With acceleration, the cycles are instead simulated until the
+  // cycle-to-cycle error converges
   if (!simparams.sim_coupled && simparams.use_cycle_to_cycle_error &&
-      this->model->get_has_windkessel_bc()) {
+      this->model->get_has_windkessel_bc() &&
+      (simparams.sim_cycle_acceleration == "none")) {
     simparams.sim_num_cycles =
         int(ceil(-1 * this->model->get_largest_windkessel_time_constant() /
                  this->model->cardiac_cycle_period *
@@ -44,6 +63,14 @@ Solver::Solver(const nlohmann::json& config) {
         (simparams.sim_pts_per_cycle - 1) * simparams.sim_num_cycles + 1;
   }
 
+  // With the periodic steady state found by shooting, a single cycle is
+  // simulated
+  if (simparams.sim_periodic_steady_state) {
+    simparams.use_cycle_to_cycle_error = false;
+    simparams.sim_num_cycles = 1;
+    simparams.sim_num_time_steps = simparams.sim_pts_per_cycle;
+  }
+
   // Calculate time step size
   if (!simparams.sim_coupled) {
     simparams.sim_time_step_size = this->model->cardiac_cycle_period /
@@ -52,26 +79,59 @@ Solver::Solver(const nlohmann::json& config) {
     simparams.sim_time_step_size = simparams.sim_external_step_size /
                                    (double(simparams.sim_num_time_steps) - 1.0);
   }
+  if (simparams.sim_adaptive_time_stepping) {
+    if (simparams.sim_min_time_step_size <= 0.0) {
+      simparams.sim_min_time_step_size = simparams.sim_time_step_size / 100.0;
+    }
+    if (simparams.sim_max_time_step_size <= 0.0) {
+      simparams.sim_max_time_step_size =
+          this->model->cardiac_cycle_period / 50.0;
+    }
+  }
+
+  // The Rosenbrock integrator splits the time steps into sub-steps controlled
+  // by its embedded error estimate instead
+  if (simparams.sim_integrator == "rosenbrock") {
+    simparams.sim_embedded_error_control = simparams.sim_adaptive_time_stepping;
+    simparams.sim_adaptive_time_stepping = false;
+  }
+
+  // Keep only the degrees-of-freedom of the output variables
+  output_dofs = select_output_dofs(*this->model, simparams.output_variables);
+  memory_sink = MemoryResultSink(simparams.output_derivative);
+  memory_sink.set_output_dofs(output_dofs);
 
   sanity_checks();
 }
 
+Solver::Solver(const Solver& solver, std::shared_ptr<Model> model)
+    : model(model),
+      simparams(solver.simparams),
+      output_dofs(solver.output_dofs),
+      initial_state(solver.initial_state) {}
+
 void Solver::setup_initial() {
   state = initial_state;
 
+  // Evaluate the model without the time tables of a previous run (enabled
+  // again in setup_integrator)
+  this->model->enable_time_tables(0.0, 0.0);
+
   // Create steady initial condition
   if (simparams.sim_steady_initial) {
     DEBUG_MSG("Calculate steady initial condition");
     double time_step_size_steady = this->model->cardiac_cycle_period / 10.0;
     this->model->to_steady();
 
-    Integrator integrator_steady(this->model.get(), time_step_size_steady,
-                                 simparams.sim_rho_infty, simparams.sim_abs_tol,
-                                 simparams.sim_nliter);
-
-    for (int i = 0; i < 31; i++) {
-      state = integrator_steady.step(state, time_step_size_steady * double(i));
-    }
+    SteadySolver steady_solver(this->model.get(), time_step_size_steady,
+                               simparams.sim_rho_infty, simparams.sim_abs_tol,
+                               simparams.sim_nliter, simparams.linear_solver,
+                               simparams.linear_solver_ordering);
+    state = steady_solver.solve(state);
+    DEBUG_MSG("Steady initial condition: "
+              << steady_solver.get_num_iterations() << " Newton iterations, "
+              << steady_solver.get_num_pseudo_transient_steps()
+              << " pseudo-transient time steps");
 
     this->model->to_unsteady();
   }
@@ -85,39 +145,87 @@ void Solver::setup_initial() {
 void Solver::setup_integrator() {
   // Set-up integrator
   DEBUG_MSG("Setup time integration");
-  integrator = Integrator(this->model.get(), simparams.sim_time_step_size,
-                          simparams.sim_rho_infty, simparams.sim_abs_tol,
-                          simparams.sim_nliter);
+  if (simparams.sim_integrator == "rosenbrock") {
+    double tolerance =
+        simparams.sim_embedded_error_control ? simparams.sim_adaptive_tol : 0.0;
+    rosenbrock = RosenbrockIntegrator(
+        this->model.get(), simparams.sim_time_step_size, tolerance,
+        simparams.sim_min_time_step_size, simparams.linear_solver,
+        simparams.linear_solver_ordering);
+    this->model->enable_time_tables(simparams.sim_time_step_size, 0.0);
+  } else {
+    // Keep the system with the analyzed sparsity pattern of the linear
+    // solver when running the simulation again (e.g. with new block
+    // parameters)
+    if (integrator_set_up) {
+      integrator.update_params(simparams.sim_time_step_size);
+      integrator.reset();
+    } else {
+      integrator = Integrator(
+          this->model.get(), simparams.sim_time_step_size,
+          simparams.sim_rho_infty, simparams.sim_abs_tol, simparams.sim_nliter,
+          simparams.linear_solver, simparams.linear_solver_ordering,
+          simparams.sim_jacobian_reuse_steps, simparams.sim_jacobian_reuse_rate,
+          simparams.sim_event_detection, simparams.sim_line_search,
+          simparams.sim_max_step_halvings, simparams.sim_predictor);
+      integrator_set_up = true;
+    }
+
+    // The time-dependent parameters take the same values in each cardiac
+    // cycle (unless the time step size varies)
+    if (simparams.sim_adaptive_time_stepping) {
+      time_stepper = AdaptiveTimeStepper(
+          &integrator, simparams.sim_adaptive_tol,
+          simparams.sim_min_time_step_size, simparams.sim_max_time_step_size,
+          this->model->cardiac_cycle_period);
+    } else {
+      this->model->enable_time_tables(simparams.sim_time_step_size,
+                                      integrator.get_time_offset());
+    }
+  }
 
   // Initialize loop
-  states = std::vector<State>();
-  times = std::vector<double>();
+  next_state = State::Zero(this->model->dofhandler.size());
+  time = 0.0;
+}
 
-  if (simparams.output_all_cycles) {
-    int num_states =
-        simparams.sim_num_time_steps / simparams.output_interval + 1;
-    states.reserve(num_states);
-    times.reserve(num_states);
+void Solver::run_integration() { run_integration(memory_sink); }
 
-  } else {
-    int num_states =
-        simparams.sim_pts_per_cycle / simparams.output_interval + 1;
-    states.reserve(num_states);
-    times.reserve(num_states);
+void Solver::run_integration(ResultSink& sink) {
+  if (simparams.sim_periodic_steady_state) {
+    find_periodic_steady_state();
   }
-  time = 0.0;
-}
 
-void Solver::run_integration() {
   // Run integrator
   DEBUG_MSG("Run time integration");
+  if (simparams.sim_adaptive_time_stepping) {
+    time_stepper.reset(state, time);
+  }
   int interval_counter = 0;
   int start_last_cycle =
       simparams.sim_num_time_steps - simparams.sim_pts_per_cycle;
 
+  // Pass the output states to the sink as they are computed (with the times
+  // starting from 0 if only the last cycle is written)
+  int num_outputs = 0;
+  if (simparams.output_all_cycles) {
+    num_outputs = simparams.sim_num_time_steps / simparams.output_interval + 1;
+  } else {
+    num_outputs = simparams.sim_pts_per_cycle / simparams.output_interval + 1;
+  }
+  sink.begin(*this->model, num_outputs);
+  int num_output_states = 0;
+  double start_time = 0.0;
+  auto add_output = [&](const State& output_state) {
+    if (!simparams.output_all_cycles && (num_output_states == 0)) {
+      start_time = time;
+    }
+    sink.write(time - start_time, output_state);
+    num_output_states++;
+  };
+
   if (simparams.output_all_cycles || (0 >= start_last_cycle)) {
-    times.push_back(time);
-    states.push_back(std::move(state));
+    add_output(state);
     DEBUG_MSG("Added initial state and time");
   }
 
@@ -133,6 +241,8 @@ void Solver::run_integration() {
               << num_time_pts_in_two_cycles << " points");
   }
 
+  // The time steps alternate between the buffers `state` and `next_state`
+  long long num_allocations = get_num_allocations();
   for (int i = 1; i < simparams.sim_num_time_steps; i++) {
     if (simparams.use_cycle_to_cycle_error) {
       if (i == simparams.sim_num_time_steps - num_time_pts_in_two_cycles + 1) {
@@ -141,7 +251,8 @@ void Solver::run_integration() {
       }
     }
 
-    state = integrator.step(state, time);
+    step(state, next_state, time);
+    state.swap(next_state);
 
     if (simparams.use_cycle_to_cycle_error &&
         last_two_cycles_time_pt_counter > 0) {
@@ -155,32 +266,74 @@ void Solver::run_integration() {
     if ((interval_counter == simparams.output_interval) ||
         (!simparams.output_all_cycles && (i == start_last_cycle))) {
       if (simparams.output_all_cycles || (i >= start_last_cycle)) {
-        times.push_back(time);
-        states.push_back(std::move(state));
+        add_output(state);
       }
       interval_counter = 0;
     }
   }
+  if (num_allocations >= 0) {
+    num_time_loop_allocations = get_num_allocations() - num_allocations;
+  }
 
   if (simparams.use_cycle_to_cycle_error) {
     std::vector<std::pair<int, int>> vessel_caps_dof_indices =
         get_vessel_caps_dof_indices();
 
-    if (!(this->model->get_has_windkessel_bc())) {
+    if (!(this->model->get_has_windkessel_bc()) ||
+        (simparams.sim_cycle_acceleration != "none")) {
       assert(last_two_cycles_time_pt_counter == num_time_pts_in_two_cycles);
       double converged = check_vessel_cap_convergence(states_last_two_cycles,
                                                       vessel_caps_dof_indices);
       int extra_num_cycles = 0;
 
+      // Extrapolate the state at the start of each cycle from the previous
+      // cycles (Aitken extrapolation is Anderson acceleration with memory 1)
+      std::unique_ptr<AndersonAcceleration> acceleration;
+      if (simparams.sim_cycle_acceleration == "anderson") {
+        acceleration = std::make_unique<AndersonAcceleration>(
+            simparams.sim_cycle_acceleration_memory);
+      } else if (simparams.sim_cycle_acceleration == "aitken") {
+        acceleration = std::make_unique<AndersonAcceleration>(1);
+      }
+      auto get_max_cycle_to_cycle_error = [&]() {
+        double max_error = 0.0;
+        for (const std::pair<int, int>& dof_indices : vessel_caps_dof_indices) {
+          auto errors = get_cycle_to_cycle_errors_in_flow_and_pressure(
+              states_last_two_cycles, dof_indices);
+          max_error = std::max({max_error, errors.first, errors.second});
+        }
+        return max_error;
+      };
+      std::vector<double> cycle_errors;
+      if (acceleration) {
+        cycle_errors.push_back(get_max_cycle_to_cycle_error());
+      }
+
       while (!converged) {
         std::rotate(
             states_last_two_cycles.begin(),
             states_last_two_cycles.begin() + simparams.sim_pts_per_cycle - 1,
             states_last_two_cycles.end());
 
+        if (acceleration) {
+          Eigen::VectorXd cycle_start = stack_state(states_last_two_cycles[0]);
+          Eigen::VectorXd cycle_end = stack_state(state);
+          Eigen::VectorXd next_start =
+              acceleration->update(cycle_start, cycle_end);
+          int size = state.y.size();
+          state.y = next_start.head(size);
+          state.ydot = next_start.tail(size);
+          states_last_two_cycles[simparams.sim_pts_per_cycle - 1] = state;
+        }
+        if (simparams.sim_adaptive_time_stepping) {
+          time_stepper.reset(state, 0.0);
+        }
+
         last_two_cycles_time_pt_counter = simparams.sim_pts_per_cycle;
         for (size_t i = 1; i < simparams.sim_pts_per_cycle; i++) {
-          state = integrator.step(state, time);
+          step(state, next_state,
+               simparams.sim_time_step_size * double(i - 1));
+          state.swap(next_state);
 
           states_last_two_cycles[last_two_cycles_time_pt_counter] = state;
           last_two_cycles_time_pt_counter += 1;
@@ -190,8 +343,7 @@ void Solver::run_integration() {
           if ((interval_counter == simparams.output_interval) ||
               (!simparams.output_all_cycles && (i == start_last_cycle))) {
             if (simparams.output_all_cycles || (i >= start_last_cycle)) {
-              times.push_back(time);
-              states.push_back(std::move(state));
+              add_output(state);
             }
             interval_counter = 0;
           }
@@ -200,12 +352,30 @@ void Solver::run_integration() {
 
         converged = check_vessel_cap_convergence(states_last_two_cycles,
                                                  vessel_caps_dof_indices);
+        if (acceleration && (extra_num_cycles == 1)) {
+          cycle_errors.push_back(get_max_cycle_to_cycle_error());
+        }
 
         assert(last_two_cycles_time_pt_counter == num_time_pts_in_two_cycles);
       }
       std::cout << "Ran simulation for " << extra_num_cycles
                 << " more cycles to converge flow and pressures at caps"
                 << std::endl;
+
+      // Estimate the number of cycles without acceleration from the reduction
+      // of the cycle-to-cycle error in the first (not accelerated) cycle
+      if (acceleration && (cycle_errors.size() > 1)) {
+        double contraction = cycle_errors[1] / cycle_errors[0];
+        if ((contraction > 0.0) && (contraction < 1.0)) {
+          int estimated_num_cycles =
+              1 + int(std::ceil(std::log(simparams.sim_cycle_to_cycle_error /
+                                         cycle_errors[1]) /
+                                std::log(contraction)));
+          std::cout << "Cycle-to-cycle acceleration saved an estimated "
+                    << std::max(estimated_num_cycles - extra_num_cycles, 0)
+                    << " cycles" << std::endl;
+        }
+      }
     } else {
       for (const std::pair<int, int>& dof_indices : vessel_caps_dof_indices) {
         std::pair<double, double> cycle_to_cycle_errors_in_flow_and_pressure =
@@ -229,23 +399,245 @@ void Solver::run_integration() {
     }
   }
 
-  DEBUG_MSG("Avg. number of nonlinear iterations per time step: "
-            << integrator.avg_nonlin_iter());
-
-  // Make times start from 0
-  if (!simparams.output_all_cycles) {
-    double start_time = times[0];
-    for (auto& time : times) {
-      time -= start_time;
+  if (simparams.sim_adaptive_time_stepping) {
+    DEBUG_MSG("Adaptive time stepping: "
+              << time_stepper.get_num_steps() << " time steps ("
+              << time_stepper.get_num_rejected_steps() << " rejected)");
+  }
+  if (simparams.sim_integrator == "rosenbrock") {
+    DEBUG_MSG("Rosenbrock integrator: "
+              << rosenbrock.get_num_steps() << " sub-steps ("
+              << rosenbrock.get_num_rejected_steps() << " rejected)");
+  } else {
+    DEBUG_MSG("Avg. number of nonlinear iterations per time step ("
+              << simparams.sim_predictor
+              << " predictor): " << integrator.avg_nonlin_iter());
+    DEBUG_MSG("Number of saved Jacobian factorizations: "
+              << integrator.num_saved_factorizations());
+    if (simparams.sim_event_detection) {
+      DEBUG_MSG("Number of events: " << integrator.num_events());
+    }
+    if (simparams.sim_line_search || (simparams.sim_max_step_halvings > 0)) {
+      DEBUG_MSG("Non-linear iterations: "
+                << integrator.num_nonlin_iter() << " ("
+                << integrator.num_backtracks() << " line search backtracks, "
+                << integrator.num_rejected_steps() << " rejected time steps)");
     }
   }
+  [[maybe_unused]] const SolverStatistics run_statistics = get_statistics();
+  [[maybe_unused]] const LinearSolverStatistics& stats =
+      run_statistics.linear_solver_statistics;
+  DEBUG_MSG("Linear solver " << run_statistics.linear_solver << ": "
+                             << stats.num_factorizations
+                             << " factorizations in "
+                             << stats.factorization_time << " s, "
+                             << stats.num_solves << " solves in "
+                             << stats.solve_time << " s");
+
+  sink.end();
   DEBUG_MSG("Ran time integration");
 }
 
-void Solver::run() {
+void Solver::step(const State& old_state, State& new_state,
+                  double old_time) {
+  if (simparams.sim_adaptive_time_stepping) {
+    time_stepper.advance(old_time + simparams.sim_time_step_size, new_state);
+  } else if (simparams.sim_integrator == "rosenbrock") {
+    rosenbrock.step(old_state, new_state, old_time);
+  } else {
+    integrator.step(old_state, new_state, old_time);
+  }
+}
+
+Eigen::VectorXd Solver::stack_state(const State& state_to_stack) {
+  Eigen::VectorXd x(2 * state_to_stack.y.size());
+  x << state_to_stack.y, state_to_stack.ydot;
+  return x;
+}
+
+State Solver::integrate_cycle(const State& start_state,
+                              Eigen::VectorXd* max_abs) {
+  int size = start_state.y.size();
+  State cycle_state = start_state;
+  if (simparams.sim_adaptive_time_stepping) {
+    time_stepper.reset(cycle_state, 0.0);
+  }
+  for (int i = 1; i < simparams.sim_pts_per_cycle; i++) {
+    step(cycle_state, next_state,
+         simparams.sim_time_step_size * double(i - 1));
+    cycle_state.swap(next_state);
+    if (max_abs) {
+      max_abs->head(size) =
+          max_abs->head(size).cwiseMax(cycle_state.y.cwiseAbs());
+      max_abs->tail(size) =
+          max_abs->tail(size).cwiseMax(cycle_state.ydot.cwiseAbs());
+    }
+  }
+  return cycle_state;
+}
+
+// Solve A x = b with GMRES (without restarts) starting from x = 0, where
+// `apply` computes the product of A with a vector. Stops when the residual
+// norm is below `tol` or after `max_iter` iterations.
+template <typename Operator>
+Eigen::VectorXd gmres(Operator&& apply, const Eigen::VectorXd& b, double tol,
+                      int max_iter) {
+  int n = b.size();
+  double beta = b.norm();
+  if (beta <= tol) {
+    return Eigen::VectorXd::Zero(n);
+  }
+
+  int m = std::min(max_iter, n);
+  Eigen::MatrixXd basis(n, m + 1);
+  Eigen::MatrixXd hessenberg = Eigen::MatrixXd::Zero(m + 1, m);
+  Eigen::VectorXd cs(m), sn(m);
+  Eigen::VectorXd g = Eigen::VectorXd::Zero(m + 1);
+  basis.col(0) = b / beta;
+  g(0) = beta;
+
+  int k = 0;
+  while (k < m) {
+    // Arnoldi step with modified Gram-Schmidt
+    Eigen::VectorXd w = apply(Eigen::VectorXd(basis.col(k)));
+    for (int j = 0; j <= k; j++) {
+      hessenberg(j, k) = w.dot(basis.col(j));
+      w -= hessenberg(j, k) * basis.col(j);
+    }
+    double w_norm = w.norm();
+    hessenberg(k + 1, k) = w_norm;
+    if (w_norm > 0.0) {
+      basis.col(k + 1) = w / w_norm;
+    }
+
+    // Givens rotations for the least-squares problem
+    for (int j = 0; j < k; j++) {
+      double h = cs(j) * hessenberg(j, k) + sn(j) * hessenberg(j + 1, k);
+      hessenberg(j + 1, k) =
+          -sn(j) * hessenberg(j, k) + cs(j) * hessenberg(j + 1, k);
+      hessenberg(j, k) = h;
+    }
+    double r = std::hypot(hessenberg(k, k), hessenberg(k + 1, k));
+    if (r == 0.0) {
+      break;
+    }
+    cs(k) = hessenberg(k, k) / r;
+    sn(k) = hessenberg(k + 1, k) / r;
+    hessenberg(k, k) = r;
+    hessenberg(k + 1, k) = 0.0;
+    g(k + 1) = -sn(k) * g(k);
+    g(k) = cs(k) * g(k);
+    k++;
+
+    if ((std::abs(g(k)) <= tol) || (w_norm == 0.0)) {
+      break;
+    }
+  }
+
+  Eigen::VectorXd coeffs = hessenberg.topLeftCorner(k, k)
+                               .triangularView<Eigen::Upper>()
+                               .solve(g.head(k));
+  return basis.leftCols(k) * coeffs;
+}
+
+void Solver::find_periodic_steady_state() {
+  DEBUG_MSG("Find periodic steady state");
+  // Maximum number of GMRES iterations (cycle evaluations) per Newton step
+  constexpr int max_krylov_iter = 30;
+  int size = state.y.size();
+  int num_cycles = 0;
+
+  auto to_vector = [&](const State& s) {
+    Eigen::VectorXd x(2 * size);
+    x << s.y, s.ydot;
+    return x;
+  };
+  auto to_state = [&](const Eigen::VectorXd& x) {
+    State s = State::Zero(size);
+    s.y = x.head(size);
+    s.ydot = x.tail(size);
+    return s;
+  };
+  // Restart each cycle from the initial adaptive time stepper (its time step
+  // size and error scale would otherwise depend on the previous cycles)
+  const AdaptiveTimeStepper initial_time_stepper = time_stepper;
+  auto cycle_map = [&](const Eigen::VectorXd& x) {
+    num_cycles++;
+    time_stepper = initial_time_stepper;
+    return to_vector(integrate_cycle(to_state(x)));
+  };
+
+  // First cycle, which also determines the scaling of the components
+  Eigen::VectorXd x = to_vector(state);
+  Eigen::VectorXd scale = x.cwiseAbs();
+  num_cycles++;
+  Eigen::VectorXd phi = to_vector(integrate_cycle(state, &scale));
+  auto scale_floor = [](const auto& part) {
+    return std::max(1.0e-6 * part.maxCoeff(), 1.0e-12);
+  };
+  scale.head(size) = scale.head(size).cwiseMax(scale_floor(scale.head(size)));
+  scale.tail(size) = scale.tail(size).cwiseMax(scale_floor(scale.tail(size)));
+  Eigen::VectorXd residual = (phi - x).cwiseQuotient(scale);
+  double error = residual.cwiseAbs().maxCoeff();
+  DEBUG_MSG("Periodic steady state error " << error);
+
+  double tol = simparams.sim_periodic_steady_state_tol;
+  int num_iter = 0;
+  for (; (num_iter < simparams.sim_periodic_steady_state_max_iter) &&
+         (error > tol);
+       num_iter++) {
+    // Product of the Jacobian of the residual with a (scaled) vector by
+    // finite differences of the cycle map
+    auto jacobian_vector = [&](const Eigen::VectorXd& v) -> Eigen::VectorXd {
+      double eps = std::sqrt(std::numeric_limits<double>::epsilon()) *
+                   (1.0 + x.cwiseQuotient(scale).norm()) / v.norm();
+      Eigen::VectorXd phi_perturbed =
+          cycle_map(x + eps * v.cwiseProduct(scale));
+      return (phi_perturbed - phi).cwiseQuotient(scale) / eps - v;
+    };
+    Eigen::VectorXd dx =
+        gmres(jacobian_vector, -residual, 0.1 * tol, max_krylov_iter);
+
+    Eigen::VectorXd x_new = x + dx.cwiseProduct(scale);
+    Eigen::VectorXd phi_new = cycle_map(x_new);
+    Eigen::VectorXd residual_new = (phi_new - x_new).cwiseQuotient(scale);
+    double error_new = residual_new.cwiseAbs().maxCoeff();
+
+    // Fixed-point step if the Newton step doesn't reduce the error
+    if (!(error_new < error)) {
+      x_new = phi;
+      phi_new = cycle_map(x_new);
+      residual_new = (phi_new - x_new).cwiseQuotient(scale);
+      error_new = residual_new.cwiseAbs().maxCoeff();
+    }
+    x = std::move(x_new);
+    phi = std::move(phi_new);
+    residual = std::move(residual_new);
+    error = error_new;
+    DEBUG_MSG("Periodic steady state error " << error);
+  }
+
+  DEBUG_MSG("Periodic steady state after "
+            << num_iter << " Newton iterations with " << num_cycles
+            << " cycle evaluations (error " << error << ")");
+  statistics.num_periodic_steady_state_iterations = num_iter;
+  statistics.num_periodic_steady_state_cycles = num_cycles;
+  statistics.periodic_steady_state_error = error;
+  if (error > tol) {
+    std::cout << "Warning: Periodic steady state did not converge in "
+              << num_iter << " Newton iterations (error " << error
+              << ", tolerance " << tol << ")" << std::endl;
+  }
+  state = to_state(x);
+  time_stepper = initial_time_stepper;
+}
+
+void Solver::run() { run(memory_sink); }
+
+void Solver::run(ResultSink& sink) {
   setup_initial();
   setup_integrator();
-  run_integration();
+  run_integration(sink);
 }
 
 std::vector<std::pair<int, int>> Solver::get_vessel_caps_dof_indices() {
@@ -336,47 +728,94 @@ Solver::get_cycle_to_cycle_errors_in_flow_and_pressure(
   return cycle_to_cycle_errors_in_flow_and_pressure;
 }
 
-std::vector<double> Solver::get_times() const { return times; }
+std::vector<double> Solver::get_times() const {
+  return memory_sink.get_times();
+}
 
-std::string Solver::get_full_result() const {
-  std::string output;
+long long Solver::get_num_time_loop_allocations() const {
+  return num_time_loop_allocations;
+}
 
-  if (simparams.output_variable_based) {
-    output = to_variable_csv(times, states, *this->model.get(),
-                             simparams.output_mean_only,
-                             simparams.output_derivative);
+SolverStatistics Solver::get_statistics() const {
+  const LinearSolver& linear_solver =
+      (simparams.sim_integrator == "rosenbrock")
+          ? rosenbrock.get_linear_solver()
+          : integrator.get_linear_solver();
+  SolverStatistics run_statistics = statistics;
+  run_statistics.linear_solver = linear_solver.get_name();
+  run_statistics.linear_solver_statistics = linear_solver.get_statistics();
+  if (simparams.sim_integrator != "rosenbrock") {
+    run_statistics.num_saved_factorizations =
+        integrator.num_saved_factorizations();
+    run_statistics.num_nonlinear_iterations = integrator.num_nonlin_iter();
+    run_statistics.num_line_search_backtracks = integrator.num_backtracks();
+    run_statistics.num_rejected_steps = integrator.num_rejected_steps();
+    if (simparams.sim_adaptive_time_stepping) {
+      run_statistics.num_adaptive_steps = time_stepper.get_num_steps();
+      run_statistics.num_rejected_adaptive_steps =
+          time_stepper.get_num_rejected_steps();
+    }
+  }
+  return run_statistics;
+}
 
-  } else {
-    output =
-        to_vessel_csv(times, states, *this->model.get(),
-                      simparams.output_mean_only, simparams.output_derivative);
+std::string Solver::get_full_result() const {
+  std::stringstream output;
+  write_result(output);
+  return output.str();
+}
+
+void Solver::write_result(std::ostream& out) const {
+  // Pass the result kept in memory to the statistics as in the output of
+  // svzerodsolver (the states are only set at the degrees-of-freedom in the
+  // output)
+  if (!simparams.output_statistics.empty()) {
+    StatisticsResultSink sink(out, simparams.output_statistics,
+                              simparams.output_statistics_per_cycle);
+    sink.set_output_dofs(output_dofs);
+    const std::vector<double>& times = memory_sink.get_times();
+    State output_state = State::Zero(this->model->dofhandler.size());
+    sink.begin(*this->model, times.size());
+    for (size_t step = 0; step < times.size(); step++) {
+      for (int dof = 0; dof < this->model->dofhandler.size(); dof++) {
+        if (memory_sink.has_dof(dof)) {
+          output_state.y[dof] = memory_sink.get_value(step, dof);
+        }
+      }
+      sink.write(times[step], output_state);
+    }
+    sink.end();
+    return;
   }
 
-  return output;
+  auto entries = get_output_entries(
+      *this->model, simparams.output_variable_based, output_dofs);
+  write_csv(out, memory_sink.get_times(), entries,
+            simparams.output_variable_based, simparams.output_mean_only,
+            simparams.output_derivative,
+            [&](int step, int dof, bool derivative) {
+              return memory_sink.get_value(step, dof, derivative);
+            });
 }
 
 Eigen::VectorXd Solver::get_single_result(const std::string& dof_name) const {
   int dof_index = this->model->dofhandler.get_variable_index(dof_name);
-  int num_states = states.size();
+  if (!memory_sink.has_dof(dof_index)) {
+    throw std::runtime_error("ERROR: Variable name '" + dof_name +
+                             "' is not in the output variables.");
+  }
+  int num_states = memory_sink.get_times().size();
   Eigen::VectorXd result = Eigen::VectorXd::Zero(num_states);
 
   for (size_t i = 0; i < num_states; i++) {
-    result[i] = states[i].y[dof_index];
+    result[i] = memory_sink.get_value(i, dof_index);
   }
 
   return result;
 }
 
 double Solver::get_single_result_avg(const std::string& dof_name) const {
-  int dof_index = this->model->dofhandler.get_variable_index(dof_name);
-  int num_states = states.size();
-  Eigen::VectorXd result = Eigen::VectorXd::Zero(num_states);
-
-  for (size_t i = 0; i < num_states; i++) {
-    result[i] = states[i].y[dof_index];
-  }
-
-  return result.mean();
+  return get_single_result(dof_name).mean();
 }
 
 void Solver::update_block_params(const std::string& block_name,
@@ -412,7 +851,170 @@ std::vector<double> Solver::read_block_params(const std::string& block_name) {
   return params;
 }
 
+EnsembleResult Solver::run_ensemble(
+    const std::vector<std::string>& block_names,
+    const Eigen::MatrixXd& block_params,
+    const std::vector<std::string>& outputs, int num_threads) {
+  // Check the parameters and outputs before starting the threads
+  std::vector<int> num_block_params;
+  for (auto& block_name : block_names) {
+    num_block_params.push_back(
+        this->model->get_block(block_name)->global_param_ids.size());
+  }
+  int num_params =
+      std::accumulate(num_block_params.begin(), num_block_params.end(), 0);
+  if (block_params.cols() != num_params) {
+    throw std::runtime_error(
+        "Ensemble parameter matrix (given columns = " +
+        std::to_string(block_params.cols()) +
+        ") does not match number of parameters of the blocks (required "
+        "columns = " +
+        std::to_string(num_params) + ")");
+  }
+  std::vector<int> ensemble_dofs;
+  for (auto& output : outputs) {
+    ensemble_dofs.push_back(
+        this->model->dofhandler.get_variable_index(output));
+  }
+
+  int num_samples = block_params.rows();
+  if (num_threads <= 0) {
+    num_threads = std::max(int(std::thread::hardware_concurrency()), 1);
+  }
+  num_threads = std::max(std::min(num_threads, num_samples), 1);
+
+  // Samples are taken from a shared counter by the threads, each with its
+  // own solver (the result of a failed sample is left empty). The times are
+  // those of the sample with the most time steps (e.g. with the cardiac
+  // cycles simulated until convergence).
+  EnsembleResult result;
+  std::vector<Eigen::MatrixXd> sample_values(num_samples);
+  std::atomic<int> next_sample{0};
+  std::mutex times_mutex;
+  std::vector<std::exception_ptr> errors(num_threads);
+  auto run_samples = [&](int thread) {
+    try {
+      Solver solver(*this, this->model->clone());
+      solver.memory_sink.set_output_dofs(ensemble_dofs);
+      while (true) {
+        int sample = next_sample++;
+        if (sample >= num_samples) {
+          break;
+        }
+        int param = 0;
+        for (size_t i = 0; i < block_names.size(); i++) {
+          std::vector<double> params(num_block_params[i]);
+          for (auto& value : params) {
+            value = block_params(sample, param++);
+          }
+          solver.update_block_params(block_names[i], params);
+        }
+        try {
+          solver.run();
+        } catch (const std::runtime_error&) {
+          continue;
+        }
+        auto& sink = solver.memory_sink;
+        Eigen::MatrixXd values(outputs.size(), sink.get_times().size());
+        for (size_t i = 0; i < sink.get_times().size(); i++) {
+          for (size_t j = 0; j < ensemble_dofs.size(); j++) {
+            values(j, i) = sink.get_value(i, ensemble_dofs[j]);
+          }
+        }
+        sample_values[sample] = std::move(values);
+        std::lock_guard<std::mutex> lock(times_mutex);
+        auto& times = solver.memory_sink.get_times();
+        if (times.size() > result.times.size()) {
+          result.times = times;
+        }
+      }
+    } catch (...) {
+      errors[thread] = std::current_exception();
+      next_sample = num_samples;
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back(run_samples, i);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  // Collect the outputs of the samples (NaN after the last time step of a
+  // sample)
+  int num_times = result.times.size();
+  result.values = std::vector<Eigen::MatrixXd>(
+      outputs.size(),
+      Eigen::MatrixXd::Constant(num_samples, num_times,
+                                std::numeric_limits<double>::quiet_NaN()));
+  for (int i = 0; i < num_samples; i++) {
+    if (sample_values[i].size() == 0) {
+      continue;
+    }
+    for (size_t j = 0; j < outputs.size(); j++) {
+      result.values[j].row(i).head(sample_values[i].cols()) =
+          sample_values[i].row(j);
+    }
+  }
+  return result;
+}
+
 void Solver::sanity_checks() {
+  // Events, predictors, globalization and reused factorizations are only
+  // implemented for the non-linear iterations of the generalized-alpha
+  // integrator (the Rosenbrock integrator is linearly implicit)
+  if (simparams.sim_integrator == "rosenbrock") {
+    const std::vector<std::pair<std::string, bool>> options = {
+        {"event_detection", simparams.sim_event_detection},
+        {"predictor", simparams.sim_predictor != "constant"},
+        {"nonlinear_line_search", simparams.sim_line_search},
+        {"maximum_time_step_halvings", simparams.sim_max_step_halvings > 0},
+        {"jacobian_reuse_steps", simparams.sim_jacobian_reuse_steps > 0}};
+    for (const auto& [name, used] : options) {
+      if (used) {
+        throw std::runtime_error("The option " + name +
+                                 " is not available with the Rosenbrock "
+                                 "integrator.");
+      }
+    }
+  }
+
+  // The statistics replace the time series in the csv output
+  if (!simparams.output_statistics.empty()) {
+    if (simparams.output_format == "binary") {
+      throw std::runtime_error(
+          "The output statistics are only available with the output format "
+          "csv.");
+    }
+    if (simparams.output_mean_only) {
+      throw std::runtime_error(
+          "The output statistics are not available with output_mean_only "
+          "(use the statistic mean instead).");
+    }
+  }
+
+  // Blocks that modify the iterates make the solution depend on the
+  // predictor and on the reuse of Jacobian factorizations
+  if ((simparams.sim_predictor != "constant") &&
+      this->model->modifies_solution()) {
+    throw std::runtime_error(
+        "The predictor " + simparams.sim_predictor +
+        " is not available with blocks that modify the solution (e.g. "
+        "ClosedLoopHeartAndPulmonary), use the constant predictor.");
+  }
+  if ((simparams.sim_jacobian_reuse_steps > 0) &&
+      this->model->modifies_solution()) {
+    throw std::runtime_error(
+        "Jacobian reuse is not available with blocks that modify the solution "
+        "(e.g. ClosedLoopHeartAndPulmonary).");
+  }
+
   // Check that steady initial is not used with ClosedLoopHeartAndPulmonary
   if ((simparams.sim_steady_initial == true) &&
       (this->model->has_block("CLH"))) {
@@ -425,6 +1027,26 @@ void Solver::sanity_checks() {
 void Solver::write_result_to_csv(const std::string& filename) const {
   DEBUG_MSG("Write output");
   std::ofstream ofs(filename);
-  ofs << get_full_result();
+  write_result(ofs);
   ofs.close();
 }
+
+std::unique_ptr<ResultSink> Solver::create_output_sink(
+    const std::string& filename) const {
+  std::unique_ptr<ResultSink> sink;
+  if (!simparams.output_statistics.empty()) {
+    sink = std::make_unique<StatisticsResultSink>(
+        filename, simparams.output_statistics,
+        simparams.output_statistics_per_cycle);
+  } else if (simparams.output_format == "binary") {
+    sink = std::make_unique<ColumnarResultSink>(
+        filename, simparams.output_derivative,
+        simparams.output_single_precision);
+  } else {
+    sink = std::make_unique<CsvResultSink>(
+        filename, simparams.output_variable_based, simparams.output_mean_only,
+        simparams.output_derivative);
+  }
+  sink->set_output_dofs(output_dofs);
+  return sink;
+}
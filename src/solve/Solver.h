@@ -5,15 +5,57 @@
  * @brief Solver source file
  */
 
+#include "AdaptiveTimeStepper.h"
 #include "Integrator.h"
 #include "Model.h"
+#include "ResultSink.h"
+#include "RosenbrockIntegrator.h"
 #include "SimulationParameters.h"
 #include "State.h"
+#include "SteadySolver.h"
 #include "debug.h"
 
 #ifndef SVZERODSOLVER_SOLVE_SOLVER_HPP_
 #define SVZERODSOLVER_SOLVE_SOLVER_HPP_
 
+/**
+ * @brief Result of an ensemble of simulations (see Solver::run_ensemble)
+ */
+struct EnsembleResult {
+  std::vector<double> times;  ///< Times of the result
+  std::vector<Eigen::MatrixXd>
+      values;  ///< Result of each output (one row per sample, one column per
+               ///< time)
+};
+
+/**
+ * @brief Statistics of the time integration of the last run (see
+ * Solver::get_statistics)
+ */
+struct SolverStatistics {
+  std::string linear_solver;  ///< Name of the linear solver
+  LinearSolverStatistics
+      linear_solver_statistics;  ///< Statistics of the linear solver
+  int num_saved_factorizations{0};  ///< Number of non-linear iterations that
+                                    ///< reused a factorization
+  int num_nonlinear_iterations{0};  ///< Number of non-linear iterations
+  int num_line_search_backtracks{
+      0};  ///< Number of halvings of the increment in the line search
+  int num_rejected_steps{0};  ///< Number of time steps that were repeated
+                              ///< with half the time step size
+  int num_adaptive_steps{0};  ///< Number of accepted adaptive time steps
+  int num_rejected_adaptive_steps{
+      0};  ///< Number of rejected adaptive time steps
+  int num_periodic_steady_state_iterations{
+      0};  ///< Number of Newton iterations of the periodic steady state
+  int num_periodic_steady_state_cycles{
+      0};  ///< Number of cardiac cycles integrated to find the periodic
+           ///< steady state
+  double periodic_steady_state_error{
+      0.0};  ///< Scaled error of the periodic steady state (see
+             ///< Solver::find_periodic_steady_state)
+};
+
 /**
  * @brief Class for running 0D simulations.
  *
@@ -40,9 +82,41 @@ class Solver {
   /// Run the integration
   void run_integration();
 
+  /**
+   * @brief Run the integration and pass the output states to a sink
+   *
+   * @param sink Receiver of the output states
+   */
+  void run_integration(ResultSink& sink);
+
   /// Run the simulation
   void run();
 
+  /**
+   * @brief Run the simulation and pass the output states to a sink as they
+   * are computed instead of keeping them in the solver
+   *
+   * The results of the solver (e.g. get_full_result) are those of the last
+   * run without a sink.
+   *
+   * @param sink Receiver of the output states
+   */
+  void run(ResultSink& sink);
+
+  /**
+   * @brief Create a sink that writes the output of the solver in the output
+   * format of the simulation parameters while integrating
+   *
+   * The csv output is that of write_result_to_csv, the binary output a
+   * columnar file (see ColumnarResultSink). With output statistics, only the
+   * statistics of the variables are written (see StatisticsResultSink).
+   *
+   * @param filename Name of the output file
+   * @return std::unique_ptr<ResultSink> Result sink
+   */
+  std::unique_ptr<ResultSink> create_output_sink(
+      const std::string& filename) const;
+
   /**
    * @brief Get the full result as a csv encoded string
    *
@@ -53,6 +127,8 @@ class Solver {
   /**
    * @brief Get the result of a single DOF over time
    *
+   * Throws an error if the DOF is not one of the output variables.
+   *
    * @param dof_name Name of the degree-of-freedom
    * @return Eigen::VectorXd Result
    */
@@ -98,18 +174,149 @@ class Solver {
    */
   void write_result_to_csv(const std::string& filename) const;
 
+  /**
+   * @brief Get the number of heap allocations in the time loop of the last
+   * run (test hook, see get_num_allocations)
+   *
+   * @return long long Number of allocations (-1 if they are not counted)
+   */
+  long long get_num_time_loop_allocations() const;
+
+  /**
+   * @brief Get the statistics of the time integration of the last run
+   *
+   * The statistics don't include the steady initial condition.
+   *
+   * @return SolverStatistics Statistics
+   */
+  SolverStatistics get_statistics() const;
+
+  /**
+   * @brief Run an ensemble of simulations with different block parameters
+   *
+   * Each sample updates the parameters of the given blocks (see
+   * update_block_params) and runs the simulation. The samples are taken by
+   * worker threads from a shared counter. Each thread has its own solver
+   * with a copy of the model (see Model::clone, with the current parameters
+   * of this solver) and keeps its integrator for all of its samples,
+   * such that the sparsity pattern and the symbolic analysis of the linear
+   * solver are only set up once per thread. This solver is not changed.
+   *
+   * The result of a sample whose simulation fails (e.g. non-linear iterations
+   * that don't converge) is NaN, as are the time steps after the end of a
+   * sample with fewer time steps than others (e.g. with the cardiac cycles
+   * simulated until convergence).
+   *
+   * @param block_names Names of the blocks with updated parameters
+   * @param block_params Parameters of the samples (one row per sample with the
+   * parameters of the blocks in the order of `block_names`)
+   * @param outputs Names of the degrees-of-freedom in the result
+   * @param num_threads Number of worker threads (0: number of hardware
+   * threads)
+   * @return EnsembleResult Times and requested outputs of all samples
+   */
+  EnsembleResult run_ensemble(const std::vector<std::string>& block_names,
+                              const Eigen::MatrixXd& block_params,
+                              const std::vector<std::string>& outputs,
+                              int num_threads = 0);
+
  private:
   std::shared_ptr<Model> model;
   SimulationParameters simparams;
-  std::vector<State> states;
+  std::vector<int> output_dofs;  ///< Degrees-of-freedom in the output
+  MemoryResultSink memory_sink;
   State initial_state;
   State state;
-  std::vector<double> times;
+  State next_state;
   double time;
   Integrator integrator;
+  RosenbrockIntegrator rosenbrock;
+  AdaptiveTimeStepper time_stepper;
+  bool integrator_set_up{false};
+  long long num_time_loop_allocations{-1};
+  SolverStatistics statistics;  ///< Statistics of the solver itself (see
+                                ///< get_statistics)
+
+  /**
+   * @brief Write the csv output of the result kept in memory
+   *
+   * With output statistics, only the statistics of the variables are written
+   * (as in create_output_sink).
+   *
+   * @param out Output stream
+   */
+  void write_result(std::ostream& out) const;
+
+  /**
+   * @brief Construct a new Solver object with the set-up of another solver
+   * and a copy of its model (see Model::clone), e.g. for another thread
+   *
+   * @param solver Solver to copy the set-up from
+   * @param model Copy of the model of the solver
+   */
+  Solver(const Solver& solver, std::shared_ptr<Model> model);
 
   void sanity_checks();
 
+  /**
+   * @brief Advance the solution by one time step of the output
+   *
+   * With adaptive time stepping, the solution at the end of the step is
+   * interpolated from the adaptive time steps, which continue from their
+   * own state (see AdaptiveTimeStepper::reset).
+   *
+   * @param old_state State at the start of the step
+   * @param new_state State at the end of the step (preallocated, not the
+   * state at the start)
+   * @param old_time Time at the start of the step
+   */
+  void step(const State& old_state, State& new_state, double old_time);
+
+  /**
+   * @brief Stack the solution and its derivative of a state into one vector
+   *
+   * @param state_to_stack State
+   * @return Eigen::VectorXd Stacked vector [y, ydot]
+   */
+  static Eigen::VectorXd stack_state(const State& state_to_stack);
+
+  /**
+   * @brief Integrate the model over one cardiac cycle
+   *
+   * Takes the same time steps as the time integration (see step), restarting
+   * the adaptive time stepping at the start of the cycle.
+   *
+   * @param start_state State at the start of the cycle
+   * @param max_abs If given, updated with the component-wise maximum absolute
+   * values of `y` and `ydot` (stacked) during the cycle
+   * @return State State at the end of the cycle
+   */
+  State integrate_cycle(const State& start_state,
+                        Eigen::VectorXd* max_abs = nullptr);
+
+  /**
+   * @brief Find the periodic steady state with a shooting method
+   *
+   * Solves $\Phi(x_0) = x_0$ for the state $x_0 = [y, \dot{y}]$ at the
+   * start of a cardiac cycle, where $\Phi$ integrates the model over one
+   * cycle. The equation is solved with a Jacobian-free Newton-Krylov method:
+   * each Newton step solves $(\partial \Phi / \partial x_0 - I) \Delta x_0 =
+   * x_0 - \Phi(x_0)$ with GMRES, approximating the products of the
+   * Jacobian with a vector by finite differences of $\Phi$. A Newton step
+   * that doesn't reduce the error is replaced by a fixed-point step
+   * $x_0 \leftarrow \Phi(x_0)$. The components are scaled with their
+   * maximum absolute values in the first cycle.
+   *
+   * With adaptive time stepping, each cycle starts from the same time
+   * stepper, so that the written cycle takes the same time steps as the
+   * cycles of the shooting method.
+   *
+   * Starts from and overwrites the current state. The number of iterations
+   * and the remaining error are kept in the statistics (see get_statistics).
+   * If the iterations don't converge, a warning is printed.
+   */
+  void find_periodic_steady_state();
+
   /**
    * @brief Get indices of flow and pressure degrees-of-freedom in solution
    * vector for all vessel caps
@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: Copyright (c) Stanford University, The Regents of the
+// University of California, and others. SPDX-License-Identifier: BSD-3-Clause
+
+#include "allocation_counter.h"
+
+#include <cstdlib>
+
+#if defined(SVZERODSOLVER_COUNT_ALLOCATIONS) && defined(__GLIBC__)
+
+#include <atomic>
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t num, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+}
+
+static std::atomic<long long> num_allocations{0};
+
+extern "C" void* malloc(size_t size) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t num, size_t size) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  return __libc_calloc(num, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  return __libc_realloc(ptr, size);
+}
+
+long long get_num_allocations() {
+  // Check that the replacement is active (the address of malloc is the one
+  // of the C library in shared libraries)
+  static const bool active = [] {
+    void* (*volatile allocate)(size_t) = std::malloc;
+    long long before = num_allocations.load();
+    std::free(allocate(1));
+    return num_allocations.load() > before;
+  }();
+  return active ? num_allocations.load() : -1;
+}
+
+#else
+
+long long get_num_allocations() { return -1; }
+
+#endif
@@ -0,0 +1,23 @@
+// SPDX-FileCopyrightText: Copyright (c) Stanford University, The Regents of the
+// University of California, and others. SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file allocation_counter.h
+ * @brief get_num_allocations source file
+ */
+#ifndef SVZERODSOLVER_SOLVE_ALLOCATIONCOUNTER_HPP_
+#define SVZERODSOLVER_SOLVE_ALLOCATIONCOUNTER_HPP_
+
+/**
+ * @brief Get the number of heap allocations so far (test hook)
+ *
+ * The allocations are only counted if the solver is built with the CMake
+ * option `ENABLE_ALLOCATION_COUNTER` (on Linux). It replaces malloc, calloc
+ * and realloc (used by `new` and the Eigen matrices) with counting versions.
+ * The replacement is only active in executables, not in shared libraries
+ * such as the Python module.
+ *
+ * @return long long Number of allocations (-1 if they are not counted)
+ */
+long long get_num_allocations();
+
+#endif  // SVZERODSOLVER_SOLVE_ALLOCATIONCOUNTER_HPP_
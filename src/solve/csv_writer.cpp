@@ -2,46 +2,32 @@
 // University of California, and others. SPDX-License-Identifier: BSD-3-Clause
 #include "csv_writer.h"
 
+#include <algorithm>
 #include <iomanip>
+#include <stdexcept>
 
-/**
- * @brief Write results vessel based.
- *
- * @param times Sequence of time steps corresponding to the solutions
- * @param states Sequence of states corresponding to the time steps
- * @param model The underlying model
- * @param mean Toggle whether only the mean over all time steps should be
- * written
- * @param derivative Toggle whether to output time-derivatives
- * @return CSV encoded output string
- */
-std::string to_vessel_csv(const std::vector<double>& times,
-                          const std::vector<State>& states, const Model& model,
-                          bool mean, bool derivative) {
-  // Create string stream to buffer output
-  std::stringstream out;
-
-  // Set floating point format for the entire stream
-  out << std::scientific << std::setprecision(16);
+std::vector<OutputEntry> get_output_entries(const Model& model,
+                                            bool variable_based,
+                                            const std::vector<int>& dofs) {
+  std::vector<OutputEntry> entries;
 
-  // Write column labels
-  if (derivative) {
-    out << "name,time,flow_in,flow_out,pressure_in,pressure_out,d_flow_in,d_"
-           "flow_out,d_pressure_in,d_pressure_out\n";
-  } else {
-    out << "name,time,flow_in,flow_out,pressure_in,pressure_out\n";
+  // Degrees-of-freedom in the output
+  std::vector<bool> selected(model.dofhandler.size(), dofs.empty());
+  for (int dof : dofs) {
+    selected[dof] = true;
   }
 
-  // Determine number of time steps
-  int num_steps = times.size();
+  if (variable_based) {
+    for (int i = 0; i < model.dofhandler.size(); i++) {
+      if (selected[i]) {
+        entries.push_back({model.dofhandler.variables[i], {int(i)}});
+      }
+    }
+    return entries;
+  }
 
-  int inflow_dof;
-  int outflow_dof;
-  int inpres_dof;
-  int outpres_dof;
   for (size_t i = 0; i < model.get_num_blocks(); i++) {
     auto block = model.get_block(i);
-    // Extract global solution indices of the block
 
     if (dynamic_cast<const BloodVessel*>(block) == nullptr &&
         dynamic_cast<const ChamberSphere*>(block) == nullptr &&
@@ -51,164 +37,111 @@ std::string to_vessel_csv(const std::vector<double>& times,
       continue;
     }
 
-    std::string name = block->get_name();
-    inflow_dof = block->inlet_nodes[0]->flow_dof;
-    outflow_dof = block->outlet_nodes[0]->flow_dof;
-    inpres_dof = block->inlet_nodes[0]->pres_dof;
-    outpres_dof = block->outlet_nodes[0]->pres_dof;
-
-    // Write the solution of the block to the output file
-    if (derivative) {
-      if (mean) {
-        double inflow_mean = 0.0;
-        double outflow_mean = 0.0;
-        double inpres_mean = 0.0;
-        double outpres_mean = 0.0;
-        double d_inflow_mean = 0.0;
-        double d_outflow_mean = 0.0;
-        double d_inpres_mean = 0.0;
-        double d_outpres_mean = 0.0;
+    // Global solution indices of the block
+    OutputEntry entry{block->get_name(),
+                      {block->inlet_nodes[0]->flow_dof,
+                       block->outlet_nodes[0]->flow_dof,
+                       block->inlet_nodes[0]->pres_dof,
+                       block->outlet_nodes[0]->pres_dof}};
+    if (std::all_of(entry.dofs.begin(), entry.dofs.end(),
+                    [&](int dof) { return selected[dof]; })) {
+      entries.push_back(entry);
+    }
+  }
 
-        for (size_t i = 0; i < num_steps; i++) {
-          inflow_mean += states[i].y[inflow_dof];
-          outflow_mean += states[i].y[outflow_dof];
-          inpres_mean += states[i].y[inpres_dof];
-          outpres_mean += states[i].y[outpres_dof];
-          d_inflow_mean += states[i].ydot[inflow_dof];
-          d_outflow_mean += states[i].ydot[outflow_dof];
-          d_inpres_mean += states[i].ydot[inpres_dof];
-          d_outpres_mean += states[i].ydot[outpres_dof];
-        }
-        inflow_mean /= num_steps;
-        outflow_mean /= num_steps;
-        inpres_mean /= num_steps;
-        outpres_mean /= num_steps;
-        d_inflow_mean /= num_steps;
-        d_outflow_mean /= num_steps;
-        d_inpres_mean /= num_steps;
-        d_outpres_mean /= num_steps;
+  return entries;
+}
 
-        out << name << ",," << inflow_mean << "," << outflow_mean << ","
-            << inpres_mean << "," << outpres_mean << "," << d_inflow_mean << ","
-            << d_outflow_mean << "," << d_inpres_mean << "," << d_outpres_mean
-            << "\n";
-      } else {
-        for (size_t i = 0; i < num_steps; i++) {
-          out << name << "," << times[i] << "," << states[i].y[inflow_dof]
-              << "," << states[i].y[outflow_dof] << ","
-              << states[i].y[inpres_dof] << "," << states[i].y[outpres_dof]
-              << "," << states[i].ydot[inflow_dof] << ","
-              << states[i].ydot[outflow_dof] << ","
-              << states[i].ydot[inpres_dof] << ","
-              << states[i].ydot[outpres_dof] << "\n";
-        }
-      }
+/**
+ * @brief Check if a name matches a pattern with the wildcards `*` and `?`
+ *
+ * @param name Name
+ * @param pattern Pattern
+ * @return bool True if the name matches the pattern
+ */
+static bool matches_pattern(const std::string& name,
+                            const std::string& pattern) {
+  // Position after the last `*` in the pattern and the position in the name
+  // it is matched up to (to continue with a longer match of the `*`)
+  size_t star = std::string::npos;
+  size_t star_match = 0;
+  size_t i = 0;
+  size_t j = 0;
+  while (i < name.size()) {
+    if ((j < pattern.size()) &&
+        ((pattern[j] == '?') || (pattern[j] == name[i]))) {
+      i++;
+      j++;
+    } else if ((j < pattern.size()) && (pattern[j] == '*')) {
+      star = ++j;
+      star_match = i;
+    } else if (star != std::string::npos) {
+      j = star;
+      i = ++star_match;
     } else {
-      if (mean) {
-        double inflow_mean = 0.0;
-        double outflow_mean = 0.0;
-        double inpres_mean = 0.0;
-        double outpres_mean = 0.0;
-
-        for (size_t i = 0; i < num_steps; i++) {
-          inflow_mean += states[i].y[inflow_dof];
-          outflow_mean += states[i].y[outflow_dof];
-          inpres_mean += states[i].y[inpres_dof];
-          outpres_mean += states[i].y[outpres_dof];
-        }
-        inflow_mean /= num_steps;
-        outflow_mean /= num_steps;
-        inpres_mean /= num_steps;
-        outpres_mean /= num_steps;
+      return false;
+    }
+  }
+  while ((j < pattern.size()) && (pattern[j] == '*')) {
+    j++;
+  }
+  return j == pattern.size();
+}
 
-        out << name << ",," << inflow_mean << "," << outflow_mean << ","
-            << inpres_mean << "," << outpres_mean << "\n";
-      } else {
-        for (size_t i = 0; i < num_steps; i++) {
-          out << name << "," << times[i] << "," << states[i].y[inflow_dof]
-              << "," << states[i].y[outflow_dof] << ","
-              << states[i].y[inpres_dof] << "," << states[i].y[outpres_dof]
-              << "\n";
-        }
+std::vector<int> select_output_dofs(const Model& model,
+                                    const std::vector<std::string>& patterns) {
+  auto& variables = model.dofhandler.variables;
+  std::vector<bool> selected(variables.size(), patterns.empty());
+  for (auto& pattern : patterns) {
+    bool found = false;
+    for (size_t i = 0; i < variables.size(); i++) {
+      if (matches_pattern(variables[i], pattern)) {
+        selected[i] = true;
+        found = true;
       }
     }
+    if (!found) {
+      throw std::runtime_error("ERROR: Output variable '" + pattern +
+                               "' not found.");
+    }
   }
 
-  return out.str();
+  std::vector<int> dofs;
+  for (size_t i = 0; i < variables.size(); i++) {
+    if (selected[i]) {
+      dofs.push_back(i);
+    }
+  }
+  return dofs;
 }
 
-/**
- * @brief Write results variable based.
- *
- * @param times Sequence of time steps corresponding to the solutions
- * @param states Sequence of states corresponding to the time steps
- * @param model The underlying model
- * @param mean Toggle whether only the mean over all time steps should be
- * written
- * @param derivative Toggle whether to output time-derivatives
- * @return CSV encoded output string
- */
-std::string to_variable_csv(const std::vector<double>& times,
-                            const std::vector<State>& states,
-                            const Model& model, bool mean, bool derivative) {
-  // Create string stream to buffer output
-  std::stringstream out;
-
+void write_csv_header(std::ostream& out, bool variable_based,
+                      bool derivative) {
   // Set floating point format for the entire stream
   out << std::scientific << std::setprecision(16);
 
-  // Determine number of time steps
-  int num_steps = times.size();
-
   // Write column labels
-  if (derivative) {
-    out << "name,time,y,ydot\n";
-    if (mean) {
-      for (size_t i = 0; i < model.dofhandler.size(); i++) {
-        std::string name = model.dofhandler.variables[i];
-        double mean_y = 0.0;
-        double mean_ydot = 0.0;
-
-        for (size_t j = 0; j < num_steps; j++) {
-          mean_y += states[j].y[i];
-          mean_ydot += states[j].ydot[i];
-        }
-        mean_y /= num_steps;
-        mean_ydot /= num_steps;
-
-        out << name << ",," << mean_y << "," << mean_ydot << "\n";
-      }
+  if (variable_based) {
+    if (derivative) {
+      out << "name,time,y,ydot\n";
     } else {
-      for (size_t i = 0; i < model.dofhandler.size(); i++) {
-        std::string name = model.dofhandler.variables[i];
-        for (size_t j = 0; j < num_steps; j++) {
-          out << name << "," << times[j] << "," << states[j].y[i] << ","
-              << states[j].ydot[i] << "\n";
-        }
-      }
+      out << "name,time,y\n";
     }
   } else {
-    out << "name,time,y\n";
-    if (mean) {
-      for (size_t i = 0; i < model.dofhandler.size(); i++) {
-        std::string name = model.dofhandler.variables[i];
-        double mean_y = 0.0;
-        for (size_t j = 0; j < num_steps; j++) {
-          mean_y += states[j].y[i];
-        }
-        mean_y /= num_steps;
-
-        out << name << ",," << mean_y << "\n";
-      }
+    if (derivative) {
+      out << "name,time,flow_in,flow_out,pressure_in,pressure_out,d_flow_in,"
+             "d_flow_out,d_pressure_in,d_pressure_out\n";
     } else {
-      for (size_t i = 0; i < model.dofhandler.size(); i++) {
-        std::string name = model.dofhandler.variables[i];
-        for (size_t j = 0; j < num_steps; j++) {
-          out << name << "," << times[j] << "," << states[j].y[i] << "\n";
-        }
-      }
+      out << "name,time,flow_in,flow_out,pressure_in,pressure_out\n";
     }
   }
+}
 
-  return out.str();
-}
\ No newline at end of file
+void write_csv_mean_row(std::ostream& out, const std::string& name,
+                        const std::vector<double>& means) {
+  out << name << ",";
+  for (double mean : means) {
+    out << "," << mean;
+  }
+  out << "\n";
+}
@@ -8,19 +8,148 @@
 #define SVZERODSOLVER_IO_CSVWRITER_HPP_
 
 #include <fstream>
+#include <ostream>
 #include <string>
 #include <vector>
 
 #include "Model.h"
 #include "State.h"
 
-std::string to_variable_csv(const std::vector<double>& times,
-                            const std::vector<State>& states,
-                            const Model& model, bool mean = false,
-                            bool derivative = false);
+/**
+ * @brief Name in the output with the degrees-of-freedom of its values
+ *
+ * The values of a csv row are the solutions of the degrees-of-freedom,
+ * followed by their time-derivatives (if written).
+ */
+struct OutputEntry {
+  std::string name;       ///< Name of the vessel or variable
+  std::vector<int> dofs;  ///< Degrees-of-freedom of the values
+};
+
+/**
+ * @brief Get the vessels or variables in the output
+ *
+ * With a subset of the degrees-of-freedom, only the variables in the subset
+ * and the vessels with all of their degrees-of-freedom in the subset are in
+ * the output.
+ *
+ * @param model The underlying model
+ * @param variable_based Toggle variable based (instead of vessel based) output
+ * @param dofs Degrees-of-freedom in the output (all if empty)
+ * @return std::vector<OutputEntry> Names in the order of the output
+ */
+std::vector<OutputEntry> get_output_entries(const Model& model,
+                                            bool variable_based,
+                                            const std::vector<int>& dofs = {});
+
+/**
+ * @brief Get the degrees-of-freedom whose variable names match any of a list
+ * of patterns
+ *
+ * A pattern is a variable name in which `*` matches any sequence of
+ * characters and `?` any single character (e.g. `pressure:*:outlet*`). Throws
+ * an error if a pattern doesn't match any variable.
+ *
+ * @param model The underlying model
+ * @param patterns Patterns of the variable names
+ * @return std::vector<int> Degrees-of-freedom in ascending order (all if there
+ * are no patterns)
+ */
+std::vector<int> select_output_dofs(const Model& model,
+                                    const std::vector<std::string>& patterns);
+
+/**
+ * @brief Write the column labels and set the floating point format
+ *
+ * @param out Output stream
+ * @param variable_based Toggle variable based (instead of vessel based) output
+ * @param derivative Toggle whether to output time-derivatives
+ */
+void write_csv_header(std::ostream& out, bool variable_based, bool derivative);
+
+/**
+ * @brief Write the row with the mean values of a name
+ *
+ * @param out Output stream
+ * @param name Name of the vessel or variable
+ * @param means Mean values
+ */
+void write_csv_mean_row(std::ostream& out, const std::string& name,
+                        const std::vector<double>& means);
+
+/**
+ * @brief Write the rows of a name at all time steps
+ *
+ * @tparam Value Callable returning the value of an index in a time step
+ * @param out Output stream
+ * @param name Name of the vessel or variable
+ * @param times Sequence of time steps
+ * @param num_values Number of values per row
+ * @param value Value of a time step and index (`value(step, index)`)
+ */
+template <typename Value>
+void write_csv_rows(std::ostream& out, const std::string& name,
+                    const std::vector<double>& times, int num_values,
+                    Value&& value) {
+  for (size_t i = 0; i < times.size(); i++) {
+    out << name << "," << times[i];
+    for (int j = 0; j < num_values; j++) {
+      out << "," << value(i, j);
+    }
+    out << "\n";
+  }
+}
+
+/**
+ * @brief Write the output of vessels or variables to a stream.
+ *
+ * @tparam Value Callable returning the value of a degree-of-freedom in a time
+ * step
+ * @param out Output stream
+ * @param times Sequence of time steps
+ * @param entries Vessels or variables in the output (see get_output_entries)
+ * @param variable_based Toggle variable based (instead of vessel based) output
+ * @param mean Toggle whether only the mean over all time steps should be
+ * written
+ * @param derivative Toggle whether to output time-derivatives
+ * @param value Solution (or its time-derivative) of a degree-of-freedom in a
+ * time step (`value(step, dof, derivative)`)
+ */
+template <typename Value>
+void write_csv(std::ostream& out, const std::vector<double>& times,
+               const std::vector<OutputEntry>& entries, bool variable_based,
+               bool mean, bool derivative, Value&& value) {
+  write_csv_header(out, variable_based, derivative);
+
+  // Determine number of time steps
+  int num_steps = times.size();
+
+  for (auto& entry : entries) {
+    int num_dofs = entry.dofs.size();
+    int num_values = derivative ? 2 * num_dofs : num_dofs;
+    auto entry_value = [&](int step, int index) {
+      if (index < num_dofs) {
+        return value(step, entry.dofs[index], false);
+      }
+      return value(step, entry.dofs[index - num_dofs], true);
+    };
 
-std::string to_vessel_csv(const std::vector<double>& times,
-                          const std::vector<State>& states, const Model& model,
-                          bool mean = false, bool derivative = false);
+    // Write the solution of the vessel or variable to the output
+    if (mean) {
+      std::vector<double> means(num_values, 0.0);
+      for (int i = 0; i < num_steps; i++) {
+        for (int j = 0; j < num_values; j++) {
+          means[j] += entry_value(i, j);
+        }
+      }
+      for (auto& mean_value : means) {
+        mean_value /= num_steps;
+      }
+      write_csv_mean_row(out, entry.name, means);
+    } else {
+      write_csv_rows(out, entry.name, times, num_values, entry_value);
+    }
+  }
+}
 
 #endif  // SVZERODSOLVER_IO_CSVWRITER_HPP_
@@ -7,7 +7,7 @@ import numpy
 import typing
 import pandas
 
-__all__ = ["Solver", "calibrate", "simulate"]
+__all__ = ["Solver", "calibrate", "read_result", "simulate"]
 
 class Solver:
     """Lumped-parameter solver."""
@@ -32,7 +32,8 @@ class Solver:
         """Get the full result of the simulation.
 
         Returns:
-            Simulation result as a dataframe.
+            Simulation result as a dataframe (only the statistics of the
+            variables with "output_statistics").
         """
         ...
     def get_single_result(self, arg0: str) -> numpy.ndarray:
@@ -55,9 +56,59 @@ class Solver:
             Mean simulation result for the DOF.
         """
         ...
+    def get_statistics(self) -> dict:
+        """Get the statistics of the time integration of the last run.
+
+        Returns:
+            Name of the linear solver with its ordering ("linear_solver"), its
+            number of factorizations ("num_factorizations",
+            "num_full_factorizations"), solves ("num_solves") and their total
+            times in seconds ("factorization_time", "solve_time"), and the
+            number of non-linear iterations ("num_nonlinear_iterations"), of
+            those that reused a factorization of the Jacobian
+            ("num_saved_factorizations"), of halvings of the increment in the
+            line search ("num_line_search_backtracks") and of time steps that
+            were repeated with half the time step size ("num_rejected_steps").
+            With adaptive time stepping, also the number of accepted and
+            rejected time steps ("num_adaptive_steps",
+            "num_rejected_adaptive_steps"). With the periodic steady state,
+            also its number of Newton iterations
+            ("num_periodic_steady_state_iterations"), integrated cardiac cycles
+            ("num_periodic_steady_state_cycles") and remaining scaled error
+            ("periodic_steady_state_error").
+        """
+        ...
     def run(self) -> None:
         """Run the simulation."""
         ...
+    def run_ensemble(
+        self,
+        block_names: list[str],
+        block_params: numpy.ndarray,
+        outputs: list[str],
+        num_threads: int = 0,
+    ) -> dict:
+        """Run an ensemble of simulations with different block parameters.
+
+        The samples are run in parallel by worker threads, each with its own
+        copy of the model. The parameters of this solver are not changed.
+
+        Args:
+            block_names: Names of the blocks with updated parameters.
+            block_params: Parameters of the samples (one row per sample with
+                the parameters of the blocks in the order of block_names).
+            outputs: Names of the degrees-of-freedom in the result.
+            num_threads: Number of worker threads (0: number of hardware
+                threads).
+
+        Returns:
+            Dictionary with the times ("time") and, for each output, its
+            values as an array with one row per sample and one column per
+            time. The values of a sample whose simulation fails are NaN, as
+            are those after the last time step of a sample with fewer time
+            steps than others.
+        """
+        ...
 
 def calibrate(arg0: dict) -> dict:
     """Run a Levenberg-Marquardt calibration.
@@ -70,6 +121,24 @@ def calibrate(arg0: dict) -> dict:
     """
     ...
 
+def read_result(arg0: str) -> dict:
+    """Read a binary result file (written with the output format "binary").
+
+    The file is memory-mapped and the arrays are read-only views into it
+    (float32 if the file was written with single precision).
+
+    Args:
+        arg0: Path to the result file.
+
+    Returns:
+        Dictionary with the times ("time"), the variable names ("variables"),
+        the values of the variables ("y", one row per variable), their
+        time-derivatives ("ydot", if written) and the indices of the inlet
+        flow, outlet flow, inlet pressure and outlet pressure variables of
+        each vessel ("vessels").
+    """
+    ...
+
 @typing.overload
 def simulate(arg0: dict) -> pandas.DataFrame:
     """Run a lumped-parameter simulation.
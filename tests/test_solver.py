@@ -4,12 +4,14 @@ import numpy as np
 import os
 import json
 import pandas as pd
+import pysvzerod
 import pytest
 
 import sys
 sys.path.append(os.path.dirname(__file__))
 
-from .utils import run_with_reference, RTOL_PRES, RTOL_FLOW
+from .utils import (get_reference, load_test_case, run_executable, run_test_case, run_test_case_with_reference,
+                    run_with_reference, RTOL_PRES, RTOL_FLOW)
 
 EXPECTED_FAILURES = {
     'closedLoopHeart_singleVessel_mistmatchPeriod.json',
@@ -77,3 +79,523 @@ def test_solver(testfile):
     ref = pd.read_json(os.path.join(results_dir, f'result_{testfile}'))
 
     run_with_reference(ref, os.path.join(this_file_dir, 'cases', testfile), rtol_pres, rtol_flow)
+
+
+@pytest.mark.parametrize('testfile', ['steadyFlow_bifurcationR_R1.json',
+                                      'closedLoopHeart_singleVessel.json'])
+@pytest.mark.parametrize('linear_solver, ordering', [('sparse_lu', 'colamd'),
+                                                     ('sparse_lu', 'amd'),
+                                                     ('sparse_lu', 'natural'),
+                                                     ('sparse_qr', 'colamd'),
+                                                     ('dense_lu', 'colamd'),
+                                                     ('klu', 'colamd'),
+                                                     ('klu', 'amd')])
+def test_linear_solver(testfile, linear_solver, ordering, tmp_path):
+    '''
+    run test cases with all linear solvers and compare against stored reference solution
+    '''
+
+    parameters = {'linear_solver': linear_solver, 'linear_solver_ordering': ordering}
+    run_test_case_with_reference(testfile, parameters, tmp_path)
+
+    # each non-linear iteration solves once with the last factorization, the statistics are those of the last run (the
+    # steady test case doesn't need any iterations)
+    solver = pysvzerod.Solver(load_test_case(testfile, parameters))
+    num_iterations = []
+    for _ in range(2):
+        solver.run()
+        statistics = solver.get_statistics()
+        assert statistics['linear_solver'].startswith(linear_solver)
+        assert statistics['num_solves'] >= statistics['num_factorizations']
+        assert statistics['factorization_time'] >= 0.0 and statistics['solve_time'] >= 0.0
+        num_iterations.append((statistics['num_factorizations'], statistics['num_solves']))
+    assert num_iterations[0] == num_iterations[1]
+    assert (num_iterations[0][1] > 0) == ('closedLoopHeart' in testfile)
+
+
+@pytest.mark.parametrize('testfile', ['pulsatileFlow_CStenosis_steadyPressure.json',
+                                      'pulsatileFlow_R_RCR.json',
+                                      'valve_tanh.json',
+                                      'piecewise_Chamber_and_Valve.json',
+                                      'closedLoopHeart_singleVessel.json'])
+@pytest.mark.parametrize('jacobian_reuse_steps', [1, 10])
+def test_jacobian_reuse(testfile, jacobian_reuse_steps, tmp_path):
+    '''
+    run test cases with reused Jacobian factorizations (modified Newton) and compare against stored reference solution
+    '''
+
+    # the valves of the closed-loop heart modify the iterates, so the solution would depend on the reused Jacobian
+    parameters = {'jacobian_reuse_steps': jacobian_reuse_steps}
+    if 'closedLoopHeart' in testfile:
+        with pytest.raises(RuntimeError, match='Jacobian reuse'):
+            pysvzerod.Solver(load_test_case(testfile, parameters))
+        return
+
+    run_test_case_with_reference(testfile, parameters, tmp_path)
+
+    # each non-linear iteration either factorizes the Jacobian or reuses the last factorization (most of them if it is
+    # reused over many time steps)
+    solver = pysvzerod.Solver(load_test_case(testfile, parameters))
+    solver.run()
+    statistics = solver.get_statistics()
+    assert statistics['num_saved_factorizations'] > 0
+    if jacobian_reuse_steps > 1:
+        assert statistics['num_saved_factorizations'] > statistics['num_factorizations']
+    assert statistics['num_solves'] == statistics['num_factorizations'] + statistics['num_saved_factorizations']
+
+
+@pytest.mark.parametrize('testfile', ['chamber_sphere.json',
+                                      'pulsatileFlow_CStenosis_steadyPressure.json',
+                                      'valve_tanh.json',
+                                      'closedLoopHeart_singleVessel.json'])
+@pytest.mark.parametrize('predictor', ['extrapolate2', 'extrapolate3', 'periodic'])
+def test_predictor(testfile, predictor, tmp_path):
+    '''
+    run test cases with predictors of the non-linear iterations and compare against stored reference solution
+    '''
+
+    # the valves of the closed-loop heart modify the iterates, so the solution would depend on the predictor
+    if 'closedLoopHeart' in testfile:
+        with pytest.raises(RuntimeError, match='constant predictor'):
+            pysvzerod.Solver(load_test_case(testfile, {'predictor': predictor}))
+        return
+
+    run_test_case_with_reference(testfile, {'predictor': predictor}, tmp_path)
+
+
+@pytest.mark.parametrize('interpolation, resampling_points, rtol', [('linear', 2001, 1.0e-3),
+                                                                   ('cubic_spline', 0, 1.0e-2),
+                                                                   ('cubic_spline', 2001, 1.0e-2)])
+def test_parameter_interpolation(interpolation, resampling_points, rtol, tmp_path):
+    '''
+    run test case with other interpolations of time-dependent parameters and compare against stored reference solution
+    '''
+
+    run_test_case_with_reference('pulsatileFlow_CStenosis_steadyPressure.json',
+                                 {'parameter_interpolation': interpolation,
+                                  'parameter_resampling_points': resampling_points}, tmp_path, rtol, rtol)
+
+
+@pytest.mark.parametrize('testfile, rtol', [('pulsatileFlow_CStenosis_steadyPressure.json', 1.0e-6),
+                                            ('closedLoopHeart_singleVessel.json', 1.0e-4)])
+def test_periodic_steady_state(testfile, rtol, tmp_path):
+    '''
+    run test cases with the periodic steady state found by shooting and compare against stored reference solution
+    '''
+
+    run_test_case_with_reference(testfile, {'periodic_steady_state': True}, tmp_path, rtol, rtol)
+
+    # each Newton iteration integrates at least two cardiac cycles after the first one
+    solver = pysvzerod.Solver(load_test_case(testfile, {'periodic_steady_state': True}))
+    solver.run()
+    statistics = solver.get_statistics()
+    assert statistics['periodic_steady_state_error'] <= 1.0e-6
+    assert statistics['num_periodic_steady_state_iterations'] > 0
+    assert statistics['num_periodic_steady_state_cycles'] >= 2 * statistics['num_periodic_steady_state_iterations'] + 1
+
+
+def test_periodic_steady_state_not_converged(capfd):
+    '''
+    run test case with too few iterations for the periodic steady state and check that a warning is printed
+    '''
+
+    config = load_test_case('pulsatileFlow_R_coronary_cycle_error.json',
+                            {'periodic_steady_state': True, 'periodic_steady_state_max_iterations': 1})
+    solver = pysvzerod.Solver(config)
+    solver.run()
+    assert solver.get_statistics()['periodic_steady_state_error'] > 1.0e-6
+    assert 'Periodic steady state did not converge' in capfd.readouterr().out
+
+
+def test_periodic_steady_state_adaptive_time_stepping(tmp_path):
+    '''
+    run test case with the periodic steady state and adaptive time stepping and check that the written cycle is
+    periodic
+    '''
+
+    testfile = 'pulsatileFlow_R_coronary_cycle_error.json'
+    config = load_test_case(testfile, {'periodic_steady_state': True, 'adaptive_time_stepping': True})
+    res = run_test_case(config, os.path.join(tmp_path, testfile))
+
+    # the shooting method uses the same adaptive time steps as the written cycle
+    for field in ['flow_in', 'pressure_in', 'flow_out', 'pressure_out']:
+        values = res[field].to_numpy()
+        assert abs(values[-1] - values[0]) <= 1.0e-6 * np.abs(values).max()
+
+
+@pytest.mark.parametrize('acceleration, rtol', [('anderson', 1.0e-4), ('aitken', 2.5e-2)])
+def test_cycle_to_cycle_acceleration(acceleration, rtol, tmp_path):
+    '''
+    run test case with accelerated cycle-to-cycle convergence and compare the last cycle against the periodic steady state
+    and the plain cycle-to-cycle iteration
+    '''
+
+    testfile = 'pulsatileFlow_R_coronary_cycle_error.json'
+
+    config = load_test_case(testfile, {'periodic_steady_state': True})
+    ref = run_test_case(config, os.path.join(tmp_path, 'periodic_' + testfile))
+
+    config = load_test_case(testfile)
+    plain = run_test_case(config, os.path.join(tmp_path, 'plain_' + testfile))
+
+    config = load_test_case(testfile, {'cycle_to_cycle_acceleration': acceleration})
+    res = run_test_case(config, os.path.join(tmp_path, testfile))
+
+    # the accelerated cycles end much closer to the periodic steady state than
+    # the stopping criterion of the cycle-to-cycle error guarantees and need
+    # fewer cycles
+    assert len(res) < len(plain)
+    for field in ['flow_in', 'pressure_in', 'flow_out', 'pressure_out']:
+        assert np.allclose(res[field].tail(len(ref)).to_numpy(), ref[field].to_numpy(), rtol=rtol, atol=0.0)
+
+    # the last cycle of the plain iteration is about 30% off in the pressures
+    # (the flow is prescribed)
+    for field in ['pressure_in', 'pressure_out']:
+        assert not np.allclose(plain[field].tail(len(ref)).to_numpy(), ref[field].to_numpy(), rtol=10.0 * rtol,
+                               atol=0.0)
+
+
+@pytest.mark.parametrize('acceleration', ['anderson', 'aitken'])
+def test_cycle_to_cycle_acceleration_windkessel(acceleration, tmp_path):
+    '''
+    run test case with RCR boundary conditions and accelerated cycle-to-cycle convergence and compare the last cycle
+    against the periodic steady state
+    '''
+
+    testfile = 'pulsatileFlow_bifurcationR_RCR_cycle_error.json'
+
+    config = load_test_case(testfile, {'periodic_steady_state': True})
+    ref = run_test_case(config, os.path.join(tmp_path, 'periodic_' + testfile))
+
+    config = load_test_case(testfile)
+    plain = run_test_case(config, os.path.join(tmp_path, 'plain_' + testfile))
+
+    # without acceleration, the number of cycles is estimated from the largest RCR time constant; with acceleration,
+    # the cycles are simulated until the cycle-to-cycle error (1%) converges
+    config = load_test_case(testfile, {'cycle_to_cycle_acceleration': acceleration})
+    res = run_test_case(config, os.path.join(tmp_path, testfile))
+
+    assert len(res) < len(plain) / 4
+    for name, ref_vessel in ref.groupby('name'):
+        res_vessel = res[res['name'] == name].tail(len(ref_vessel))
+        for field in ['flow_in', 'pressure_in', 'flow_out', 'pressure_out']:
+            assert np.allclose(res_vessel[field].to_numpy(), ref_vessel[field].to_numpy(), rtol=1.0e-2, atol=1.0e-8)
+
+
+@pytest.mark.parametrize('testfile', ['pulsatileFlow_R_RCR.json', 'pulsatileFlow_R_coronary.json'])
+def test_adaptive_time_stepping(testfile, tmp_path):
+    '''
+    run test case with adaptive time stepping and compare the interpolated output against stored reference solution
+    '''
+
+    ref = get_reference(testfile)
+    config = load_test_case(testfile, {'adaptive_time_stepping': True})
+    res = run_test_case(config, os.path.join(tmp_path, testfile))
+
+    # the interpolated output crosses zero at slightly different times, so the
+    # error is compared against the range of each field
+    for field in ['flow_in', 'pressure_in', 'flow_out', 'pressure_out']:
+        scale = np.abs(ref[field].to_numpy()).max()
+        assert np.allclose(res[field].to_numpy(), ref[field].to_numpy(), rtol=0.0, atol=2.0e-3 * scale)
+
+    # most adaptive time steps take the maximum size of a fiftieth of the
+    # cardiac cycle (four times the fixed one) without rejections
+    solver = pysvzerod.Solver(config)
+    solver.run()
+    statistics = solver.get_statistics()
+    sim_params = config['simulation_parameters']
+    num_fixed_steps = (sim_params['number_of_time_pts_per_cardiac_cycle'] - 1) * sim_params['number_of_cardiac_cycles']
+    assert 0 < statistics['num_adaptive_steps'] < num_fixed_steps / 3
+    assert statistics['num_rejected_adaptive_steps'] < 0.1 * statistics['num_adaptive_steps']
+
+
+@pytest.mark.parametrize('testfile', ['pulsatileFlow_R_RCR.json', 'pulsatileFlow_R_coronary.json',
+                                      'pulsatileFlow_CRL.json'])
+@pytest.mark.parametrize('adaptive', [False, True])
+def test_rosenbrock_integrator(testfile, adaptive, tmp_path):
+    '''
+    run test case with the Rosenbrock integrator (with and without sub-steps) and compare against stored reference solution
+    '''
+
+    ref = get_reference(testfile)
+    config = load_test_case(testfile, {'integrator': 'rosenbrock', 'adaptive_time_stepping': adaptive})
+    res = run_test_case(config, os.path.join(tmp_path, testfile))
+
+    # the reference is computed with the generalized-alpha method, so the error
+    # is compared against the range of each field
+    for field in ['flow_in', 'pressure_in', 'flow_out', 'pressure_out']:
+        scale = np.abs(ref[field].to_numpy()).max()
+        assert np.allclose(res[field].to_numpy(), ref[field].to_numpy(), rtol=0.0, atol=1.0e-2 * scale)
+
+
+@pytest.mark.parametrize('option, value', [('event_detection', True), ('predictor', 'extrapolate2'),
+                                           ('nonlinear_line_search', True), ('maximum_time_step_halvings', 4),
+                                           ('jacobian_reuse_steps', 10)])
+def test_rosenbrock_integrator_options(option, value):
+    '''
+    check that the options of the non-linear iterations of the generalized-alpha integrator are rejected with the
+    Rosenbrock integrator
+    '''
+
+    config = load_test_case('pulsatileFlow_R_RCR.json', {'integrator': 'rosenbrock', option: value})
+    with pytest.raises(RuntimeError, match=option):
+        pysvzerod.Solver(config)
+
+
+def test_event_detection(tmp_path):
+    '''
+    run test case with event detection at the valve switches and compare against a solution with a finer time step size
+    '''
+
+    testfile = 'closedLoopHeart_singleVessel.json'
+
+    config = load_test_case(testfile)
+    num_pts = config['simulation_parameters']['number_of_time_pts_per_cardiac_cycle']
+
+    # reference with an eight times smaller time step size at the same output times
+    config = load_test_case(testfile, {'number_of_time_pts_per_cardiac_cycle': 8 * (num_pts - 1) + 1,
+                                       'output_interval': 8})
+    ref = run_test_case(config, os.path.join(tmp_path, 'fine_' + testfile))
+
+    res = run_test_case(load_test_case(testfile, {'event_detection': True}), os.path.join(tmp_path, testfile))
+
+    # without event detection, the valve switches are only resolved to a time
+    # step, which causes errors of 10-20% of the range of the solution
+    for field in ['flow_in', 'pressure_in', 'flow_out', 'pressure_out']:
+        scale = np.abs(ref[field].to_numpy()).max()
+        assert np.allclose(res[field].to_numpy(), ref[field].to_numpy(), rtol=0.0, atol=5.0e-2 * scale)
+
+
+@pytest.mark.parametrize('testfile', ['steadyFlow_stenosis_R.json', 'steadyFlow_R_coronary.json'])
+def test_steady_initial_condition(testfile, tmp_path):
+    '''
+    run steady test case for one cardiac cycle and check that the solution doesn't change from the steady initial condition
+    '''
+
+    config = load_test_case(testfile, {'number_of_cardiac_cycles': 1, 'steady_initial': True})
+    res = run_test_case(config, os.path.join(tmp_path, testfile))
+
+    for field in ['flow_in', 'pressure_in', 'flow_out', 'pressure_out']:
+        assert np.allclose(res[field].to_numpy(), res[field].iloc[-1], rtol=1.0e-10, atol=0.0)
+
+
+@pytest.mark.parametrize('globalization', [{'nonlinear_line_search': True}, {'maximum_time_step_halvings': 4}])
+def test_nonlinear_globalization(globalization):
+    '''
+    run chamber test case with few non-linear iterations per time step that fail without line search or time step
+    halving and compare against a reference solution with a ten times smaller time step size
+    '''
+
+    testfile = 'chamber_sphere.json'
+    parameters = {'number_of_time_pts_per_cardiac_cycle': 101, 'maximum_nonlinear_iterations': 8}
+
+    # the non-linear iterations of the time step at t = 0.19 don't converge
+    with pytest.raises(RuntimeError, match='Maximum number of non-linear iterations'):
+        pysvzerod.Solver(load_test_case(testfile, parameters)).run()
+
+    solver = pysvzerod.Solver(load_test_case(testfile, {**parameters, **globalization}))
+    solver.run()
+    res = solver.get_full_result()
+    statistics = solver.get_statistics()
+    if 'nonlinear_line_search' in globalization:
+        assert statistics['num_line_search_backtracks'] > 0
+        assert statistics['num_rejected_steps'] == 0
+    else:
+        assert statistics['num_line_search_backtracks'] == 0
+        assert statistics['num_rejected_steps'] > 0
+    assert statistics['num_nonlinear_iterations'] > 0
+
+    # the line search doesn't change the converged solution
+    if 'nonlinear_line_search' in globalization:
+        converged = pysvzerod.simulate(load_test_case(testfile, {'number_of_time_pts_per_cardiac_cycle': 101}))
+        assert np.allclose(res['y'].to_numpy(), converged['y'].to_numpy(), rtol=1.0e-6, atol=1.0e-6)
+
+    # the volume and pressure of the chamber are within the time discretization error (the valve flows switch
+    # between the output time steps)
+    ref = pysvzerod.simulate(load_test_case(testfile, {'number_of_time_pts_per_cardiac_cycle': 1001,
+                                                       'output_interval': 10}))
+    for name, tol in [('volume:ventricle', 1.0e-2), ('pressure:ventricle:outlet_valve', 5.0e-2)]:
+        res_y = res[res['name'] == name]['y'].to_numpy()
+        ref_y = ref[ref['name'] == name]['y'].to_numpy()
+        assert len(res_y) == len(ref_y) == 101
+        assert np.allclose(res_y, ref_y, rtol=0.0, atol=tol * np.ptp(ref_y))
+
+
+@pytest.mark.parametrize('testfile', ['pulsatileFlow_R_RCR.json', 'closedLoopHeart_singleVessel.json',
+                                      'pulsatileFlow_CStenosis_steadyPressure.json'])
+@pytest.mark.parametrize('linear_solver', ['klu', 'dense_lu'])
+@pytest.mark.parametrize('adaptive', [False, True])
+def test_time_loop_allocations(testfile, linear_solver, adaptive, tmp_path):
+    '''
+    run test case for one and two cardiac cycles and check that the time steps don't allocate heap memory (requires the
+    executable built with ENABLE_ALLOCATION_COUNTER=ON)
+    '''
+
+    def count_allocations(num_cycles):
+        config = load_test_case(testfile, {'linear_solver': linear_solver, 'number_of_cardiac_cycles': num_cycles,
+                                           'adaptive_time_stepping': adaptive})
+        output = run_executable(config, os.path.join(tmp_path, testfile), os.path.join(tmp_path, 'out.csv'))
+        for line in output.splitlines():
+            if 'Heap allocations in time loop' in line:
+                return int(line.split(':')[-1])
+        pytest.skip('svzerodsolver built without ENABLE_ALLOCATION_COUNTER')
+
+    # only the first time step allocates (the time tables and the first factorization), the linear solver is pinned to
+    # klu or dense_lu because the default sparse_lu solver of Eigen allocates in each solve
+    assert count_allocations(1) == count_allocations(2)
+
+
+@pytest.mark.parametrize('testfile, block, outputs', [
+    ('pulsatileFlow_R_RCR.json', 'OUT', ['flow:INFLOW:branch0_seg0', 'pressure:branch0_seg0:OUT']),
+    ('piecewise_Chamber_and_Valve.json', 'left_ventricle', ['flow:J0:Rpul_artery', 'pressure:pul_artery:J0']),
+    ('chamber_elastance_inductor.json', 'ventricle', ['Vc:ventricle', 'pressure:ventricle:valve1'])])
+def test_run_ensemble(testfile, block, outputs):
+    '''
+    run an ensemble of test cases with scaled block parameters on two threads and compare it to the simulations of the
+    samples one after the other (the worker threads reuse their solver for several samples)
+    '''
+
+    config = load_test_case(testfile)
+
+    solver = pysvzerod.Solver(config)
+    params = np.array(solver.read_block_params(block))
+    block_params = np.array([scale * params for scale in [1.0, 1.1, 0.9, 1.05, 1.0]])
+    result = solver.run_ensemble([block], block_params, outputs, num_threads=2)
+
+    for i, sample_params in enumerate(block_params):
+        sample_solver = pysvzerod.Solver(config)
+        sample_solver.update_block_params(block, list(sample_params))
+        sample_solver.run()
+        assert np.array_equal(result['time'], sample_solver.get_times())
+        for output in outputs:
+            assert np.array_equal(result[output][i], sample_solver.get_single_result(output))
+
+
+@pytest.mark.parametrize('testfile', ['pulsatileFlow_R_RCR.json', 'closedLoopHeart_singleVessel.json'])
+@pytest.mark.parametrize('output', [{}, {'output_variable_based': True}, {'output_mean_only': True},
+                                    {'output_derivative': True, 'output_all_cycles': True}])
+def test_streamed_csv_output(testfile, output, tmp_path):
+    '''
+    run test case with the executable, which writes the csv file while integrating, and compare it to the result kept
+    in memory by the Python interface
+    '''
+
+    config = load_test_case(testfile, output)
+    output_file = os.path.join(tmp_path, 'out.csv')
+    run_executable(config, os.path.join(tmp_path, testfile), output_file)
+
+    solver = pysvzerod.Solver(config)
+    solver.run()
+    pd.testing.assert_frame_equal(pd.read_csv(output_file), solver.get_full_result())
+
+    # the temporary spill file is removed
+    assert sorted(os.listdir(tmp_path)) == sorted([testfile, 'out.csv'])
+
+
+@pytest.mark.parametrize('testfile', ['pulsatileFlow_R_RCR.json', 'closedLoopHeart_singleVessel.json'])
+@pytest.mark.parametrize('output', [{}, {'output_derivative': True}, {'output_single_precision': True}])
+def test_binary_output(testfile, output, tmp_path):
+    '''
+    run test case with the executable, which writes the binary columnar file, and compare the arrays mapped by
+    pysvzerod.read_result to the result kept in memory by the Python interface
+    '''
+
+    config = load_test_case(testfile, dict(output, output_format='binary'))
+    output_file = os.path.join(tmp_path, 'out.bin')
+    run_executable(config, os.path.join(tmp_path, testfile), output_file)
+
+    solver = pysvzerod.Solver(config)
+    solver.run()
+    result = pysvzerod.read_result(output_file)
+    dtype = np.float32 if output.get('output_single_precision', False) else np.float64
+
+    assert np.array_equal(result['time'], solver.get_times())
+    assert result['y'].dtype == dtype
+    assert not result['y'].flags.writeable
+    assert ('ydot' in result) == output.get('output_derivative', False)
+    for i, name in enumerate(result['variables']):
+        assert np.array_equal(result['y'][i], solver.get_single_result(name).astype(dtype))
+    for name, dofs in result['vessels'].items():
+        assert len(dofs) == 4
+
+    # the temporary spill file is removed
+    assert sorted(os.listdir(tmp_path)) == sorted([testfile, 'out.bin'])
+
+
+@pytest.mark.parametrize('output', [{}, {'output_variable_based': True}, {'output_mean_only': True},
+                                    {'output_variable_based': True, 'output_derivative': True}])
+def test_output_variables(output):
+    '''
+    run test case with a subset of the output variables (given by names and patterns) and compare it to the
+    corresponding rows of the full result
+    '''
+
+    config = load_test_case('closedLoopHeart_singleVessel.json', output)
+
+    solver = pysvzerod.Solver(config)
+    solver.run()
+    full_result = solver.get_full_result()
+
+    config['simulation_parameters']['output_variables'] = ['V_LV:CLH', 'pressure:branch0_seg0:*', '*:J_heart_outlet:branch0_seg0',
+                                                           'flow:branch0_seg0:RCR_a?rta']
+    solver = pysvzerod.Solver(config)
+    solver.run()
+    result = solver.get_full_result()
+
+    if output.get('output_variable_based', False):
+        names = ['V_LV:CLH', 'pressure:branch0_seg0:RCR_aorta', 'flow:J_heart_outlet:branch0_seg0',
+                 'pressure:J_heart_outlet:branch0_seg0', 'flow:branch0_seg0:RCR_aorta']
+    else:
+        names = ['branch0_seg0']
+    expected = full_result[full_result['name'].isin(names)].reset_index(drop=True)
+    assert sorted(result['name'].unique()) == sorted(names)
+    pd.testing.assert_frame_equal(result, expected)
+
+    # only the selected variables are kept
+    with pytest.raises(RuntimeError):
+        solver.get_single_result('V_RV:CLH')
+
+    config['simulation_parameters']['output_variables'] = ['volume:*']
+    with pytest.raises(RuntimeError):
+        pysvzerod.Solver(config)
+
+
+@pytest.mark.parametrize('per_cycle', [False, True])
+def test_output_statistics(per_cycle, tmp_path):
+    '''
+    run test case with the executable, which writes the statistics of the variables while integrating, and compare
+    them to the statistics of the result kept in memory by the Python interface
+    '''
+
+    testfile = 'closedLoopHeart_singleVessel.json'
+    parameters = {'output_all_cycles': True, 'output_variables': ['pressure:*'],
+                  'output_statistics': ['mean', 'min', 'max', 'rms', 'amplitude'],
+                  'output_statistics_per_cycle': per_cycle}
+    config = load_test_case(testfile, parameters)
+    output_file = os.path.join(tmp_path, 'statistics.csv')
+    run_executable(config, os.path.join(tmp_path, testfile), output_file)
+    statistics = pd.read_csv(output_file)
+
+    solver = pysvzerod.Solver(config)
+    solver.run()
+    num_pts = config['simulation_parameters']['number_of_time_pts_per_cardiac_cycle']
+    num_cycles = config['simulation_parameters']['number_of_cardiac_cycles']
+    assert len(statistics) == 5 * (num_cycles if per_cycle else 1)
+    for _, row in statistics.iterrows():
+        values = solver.get_single_result(row['name'])
+        if per_cycle:
+            # the time step at the end of a cycle is part of both cycles
+            values = values[row['cycle'] * (num_pts - 1):(row['cycle'] + 1) * (num_pts - 1) + 1]
+        assert np.isclose(row['mean'], np.mean(values), rtol=1e-12)
+        assert row['min'] == np.min(values)
+        assert row['max'] == np.max(values)
+        assert np.isclose(row['rms'], np.sqrt(np.mean(values ** 2)), rtol=1e-12)
+        assert np.isclose(row['amplitude'], np.max(values) - np.min(values), rtol=1e-12)
+
+    # the Python interface returns the same statistics
+    pd.testing.assert_frame_equal(solver.get_full_result(), statistics)
+
+    # the statistics are only written as csv and replace the mean values
+    for option, value in [('output_format', 'binary'), ('output_mean_only', True)]:
+        with pytest.raises(RuntimeError, match='output statistics'):
+            pysvzerod.Solver(load_test_case(testfile, {**parameters, option: value}))
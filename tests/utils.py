@@ -8,7 +8,7 @@ import pandas as pd
 
 # global boolean to perform coverage testing
 # (run executables instead of Python interface, much slower)
-from pytest import coverage
+from pytest import coverage, skip
 
 import pysvzerod
 
@@ -147,6 +147,78 @@ def run_with_reference(
 
 
 
+def load_test_case(testfile, parameters=None):
+    """Load the configuration of a test case.
+
+    Args:
+        testfile: Name of the test case file in the cases folder.
+        parameters: Simulation parameters that replace the ones of the test case.
+    """
+    with open(os.path.join(this_file_dir, "cases", testfile)) as ff:
+        config = json.load(ff)
+    config["simulation_parameters"].update(parameters or {})
+    return config
+
+
+def write_config(config, input_file):
+    """Write a configuration to an input file and return its path."""
+    with open(input_file, "w") as ff:
+        json.dump(config, ff)
+    return input_file
+
+
+def get_reference(testfile):
+    """Read the stored reference solution of a test case."""
+    return pd.read_json(os.path.join(this_file_dir, "cases", "results", f"result_{testfile}"))
+
+
+def run_test_case(config, input_file):
+    """Write a configuration to an input file and run it (via Python interface or executable).
+
+    Args:
+        config: Configuration of the simulation.
+        input_file: Path of the input file to write.
+    """
+    result, _ = execute_pysvzerod(write_config(config, input_file), "solver")
+    return result
+
+
+def run_test_case_with_reference(testfile, parameters, tmp_path, rtol_pres=RTOL_PRES, rtol_flow=RTOL_FLOW):
+    """Run a test case with replaced simulation parameters and compare it against the stored reference solution.
+
+    Args:
+        testfile: Name of the test case file in the cases folder.
+        parameters: Simulation parameters that replace the ones of the test case.
+        tmp_path: Directory for the modified input file.
+    """
+    input_file = write_config(load_test_case(testfile, parameters), os.path.join(tmp_path, testfile))
+    run_with_reference(get_reference(testfile), input_file, rtol_pres, rtol_flow)
+
+
+def get_executable():
+    """Path of the svzerodsolver executable (skips the test if it isn't built)."""
+    exe = os.path.join(this_file_dir, "..", "Release", "svzerodsolver")
+    if not os.path.exists(exe):
+        skip("svzerodsolver executable not found")
+    return exe
+
+
+def run_executable(config, input_file, output_file):
+    """Write a configuration to an input file and run it with the svzerodsolver executable.
+
+    Args:
+        config: Configuration of the simulation.
+        input_file: Path of the input file to write.
+        output_file: Path of the output file.
+
+    Returns:
+        Standard output of the executable.
+    """
+    exe = get_executable()
+    return subprocess.run([exe, write_config(config, input_file), output_file], capture_output=True, text=True,
+                          check=True).stdout
+
+
 def run_test_case_by_name(name, output_variable_based=False, folder="."):
     """Run a test case by its case name.
 